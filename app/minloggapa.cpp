@@ -6,27 +6,68 @@
 
 #include <ctime>
 #include <iostream>
+#include <map>
+#include <stdexcept>
 
+#include "data-structure/numa_allocator.h"
 #include "experiments.h"
 #include "initial-partitioner/configuration.h"
+#include "initial-partitioner/graph_growing_initial_partitioner.h"
 #include "initial-partitioner/kahip_initial_partitioner.h"
+#include "initial-partitioner/layout_initial_partitioner.h"
+#include "initial-partitioner/minhash_initial_partitioner.h"
+#include "initial-partitioner/multilevel_initial_partitioner.h"
+#include "initial-partitioner/sampling_initial_partitioner.h"
+#include "initial-partitioner/spectral_initial_partitioner.h"
 #include "refinement/basic_refiner.h"
+#include "refinement/batch_refiner.h"
 #include "refinement/fm_refiner.h"
+#include "refinement/lp_refiner.h"
+#include "refinement/multilevel_refiner.h"
 #include "report/cli_reporter.h"
 #include "utils.h"
 
 using namespace bathesis;
 
 int main(int argc, char *argv[]) {
+    bool compress = false;
+    for (; argc >= 2 && std::string(argv[1]).compare(0, 2, "--") == 0; ++argv, --argc) {
+        const std::string flag = argv[1];
+        if (flag == "--compress") {
+            compress = true;
+        } else if (flag == "--interleave") {
+            page_allocation::global_options().interleave = true;
+        } else if (flag == "--explicit-huge-pages") {
+            page_allocation::global_options().explicit_huge_pages = true;
+        } else {
+            std::cerr << "unknown option " << flag << "\n";
+            argc = 1;
+            break;
+        }
+    }
+
     if (argc < 2) {
         std::cerr
-            << "usage: ./minloggapa <graph> [<kahip|random> <fm|basic>]\n";
+            << "usage: ./minloggapa [--compress] [--interleave] [--explicit-huge-pages] <graph> [<partitioner schedule> <refiner schedule> [<time limit in seconds> [<layout file>]]]\n"
+            << "  --compress keeps the adjacency of the query graph gap encoded, which saves memory at some cost in time\n"
+            << "  --interleave spreads the pages of large arrays over all NUMA nodes instead of placing them by first touch\n"
+            << "  --explicit-huge-pages backs large arrays by reserved huge pages if available, not transparent ones\n"
+            << "  partitioners: kahip, kahip-jaccard, kahip-sampled, multilevel, growing, minhash, spectral, layout, layout-bfs, random\n"
+            << "  kahip-jaccard weights data edges by the Jaccard similarity of the query neighborhoods\n"
+            << "  kahip-sampled bisects a sample of at most about 2^20 data nodes with kahip\n"
+            << "  layout splits the input order or, if given, the layout read from <layout file>\n"
+            << "  refiners: fm, fm-boundary, basic, batch, lp, lp-boundary, multilevel\n"
+            << "  a schedule is a single name or a list of rules name[:condition,...];...\n"
+            << "  with conditions on depth, nodes or edges, e.g. \"kahip:nodes>=1000000;growing\";\n"
+            << "  the first matching rule applies, otherwise the last one\n";
         std::exit(1);
     }
 
     const std::string graph = argv[1];
     const std::string partitioner = (argc >= 3 ? argv[2] : "kahip");
     const std::string refiner = (argc >= 4 ? argv[3] : "basic");
+    const double time_limit = (argc >= 5 ? std::atof(argv[4]) : 0.0);
+    const std::string layout_filename = (argc >= 6 ? argv[5] : "");
 
     std::cerr << "graph: " << graph << " partitioner=" << partitioner
               << " refiner=" << refiner << "\n";
@@ -38,31 +79,74 @@ int main(int argc, char *argv[]) {
         };
     uint seed = static_cast<uint>(std::time(nullptr));
     kahip_initial_partitioner kahip(3, 1, seed, kahip_configuration);
+    kahip_initial_partitioner kahip_jaccard(3, 1, seed, kahip_configuration, 1,
+                                            edge_weighting::jaccard);
+    sampling_initial_partitioner kahip_sampled(kahip, seed);
+    multilevel_initial_partitioner<> multilevel_partitioner(3, 1, seed);
+    graph_growing_initial_partitioner growing(seed);
+    minhash_initial_partitioner minhash(seed);
+    spectral_initial_partitioner spectral(seed);
+    layout_initial_partitioner layout(
+        3, 1, [&layout_filename](graph_access &G) {
+            if (layout_filename.empty()) {
+                return utils::create_identity_layout(G);
+            }
+            std::vector<NodeID> linear_layout(G.number_of_nodes());
+            graph_io::readVector(linear_layout, layout_filename);
+            return linear_layout;
+        });
+    layout_initial_partitioner layout_bfs(3, 1, utils::create_bfs_layout);
     random_initial_partitioner random(seed);
     fm_refiner fm;
-    basic_refiner basic;
+    fm_refiner fm_boundary(3, 1, true);
+    basic_refiner<> basic;
+    batch_refiner<> batch;
+    lp_refiner<> lp;
+    lp_refiner<> lp_boundary(3, 1, true);
+    multilevel_refiner<> multilevel;
 
     cli_reporter rep;
 
     const bool compute_quadtree_cost = false;
     const int max_levels = 7;
 
-    if (partitioner == "kahip") {
-        if (refiner == "fm") {
-            utils::process_graph(graph, "kahip,fm", kahip, fm, rep,
-                                 compute_quadtree_cost, max_levels);
-        } else if (refiner == "basic") {
-            utils::process_graph(graph, "kahip,basic", kahip, basic, rep,
-                                 compute_quadtree_cost, max_levels);
-        }
-    } else if (partitioner == "random") {
-        if (refiner == "fm") {
-            utils::process_graph(graph, "random,fm", random, fm, rep,
-                                 compute_quadtree_cost, max_levels);
-        } else if (refiner == "basic") {
-            utils::process_graph(graph, "random,basic", random, basic, rep,
-                                 compute_quadtree_cost, max_levels);
-        }
+    const std::map<std::string, initial_partitioner_interface *> partitioners = {
+        {"kahip", &kahip},
+        {"kahip-jaccard", &kahip_jaccard},
+        {"kahip-sampled", &kahip_sampled},
+        {"multilevel", &multilevel_partitioner},
+        {"growing", &growing},
+        {"minhash", &minhash},
+        {"spectral", &spectral},
+        {"layout", &layout},
+        {"layout-bfs", &layout_bfs},
+        {"random", &random}};
+    const std::map<std::string, refiner_interface *> refiners = {
+        {"fm", &fm},
+        {"fm-boundary", &fm_boundary},
+        {"basic", &basic},
+        {"batch", &batch},
+        {"lp", &lp},
+        {"lp-boundary", &lp_boundary},
+        {"multilevel", &multilevel}};
+
+    partitioner_schedule partitioner_selection;
+    refiner_schedule refiner_selection;
+    try {
+        partitioner_selection = partitioner_schedule::parse(partitioner, partitioners);
+        refiner_selection = refiner_schedule::parse(refiner, refiners);
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << "\n";
+        std::exit(1);
+    }
+
+    try {
+        utils::process_graph(graph, partitioner + "," + refiner,
+                             partitioner_selection, refiner_selection, rep,
+                             compute_quadtree_cost, max_levels, time_limit, compress);
+    } catch (const std::invalid_argument &e) { // e.g. a malformed layout file
+        std::cerr << e.what() << "\n";
+        std::exit(1);
     }
 
     return EXIT_SUCCESS;
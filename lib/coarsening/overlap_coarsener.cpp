@@ -0,0 +1,201 @@
+#include "overlap_coarsener.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+using namespace bathesis;
+
+overlap_coarsener::overlap_coarsener(NodeID max_query_degree) : m_max_query_degree(max_query_degree) {
+}
+
+/**
+ * Greedily matches every data node with the unmatched data node of the same partition that shares the most query
+ * nodes with it.
+ *
+ * A shared query node is rated by the inverse of its degree, i.e. small query nodes count more. Query nodes with a
+ * degree above the limit given to the constructor are ignored. Nodes are visited in order of increasing degree.
+ *
+ * @param G
+ * @param max_node_weight no two nodes whose weights sum up to more than this are matched
+ * @param map output: map[data node] = coarse data node
+ * @return the number of coarse data nodes
+ */
+NodeID overlap_coarsener::compute_matching(const weighted_query_graph &G, NodeID max_node_weight,
+                                           std::vector<NodeID> &map) {
+    const NodeID n = G.number_of_data_nodes();
+    const NodeID unmatched = std::numeric_limits<NodeID>::max();
+
+    std::vector<NodeID> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&G](NodeID left, NodeID right) {
+        return G.get_first_invalid_data_edge(left) - G.get_first_data_edge(left)
+               < G.get_first_invalid_data_edge(right) - G.get_first_data_edge(right);
+    });
+
+    std::vector<NodeID> mate(n, unmatched);
+    std::vector<double> rating(n, 0.0);
+    std::vector<NodeID> touched;
+
+    for (NodeID u : order) {
+        if (mate[u] != unmatched) {
+            continue;
+        }
+
+        for (EdgeID e = G.get_first_data_edge(u); e < G.get_first_invalid_data_edge(u); ++e) {
+            NodeID q = G.get_data_edge_target(e);
+            EdgeID degree = G.get_first_invalid_query_edge(q) - G.get_first_query_edge(q);
+            if (degree < 2 || degree > m_max_query_degree) {
+                continue;
+            }
+
+            for (EdgeID f = G.get_first_query_edge(q); f < G.get_first_invalid_query_edge(q); ++f) {
+                NodeID v = G.get_query_edge_target(f);
+                if (v == u || mate[v] != unmatched || G.get_partition(v) != G.get_partition(u)
+                    || G.get_node_weight(u) + G.get_node_weight(v) > max_node_weight) {
+                    continue;
+                }
+
+                if (rating[v] == 0.0) {
+                    touched.push_back(v);
+                }
+                rating[v] += static_cast<double>(std::min(G.get_data_edge_weight(e), G.get_query_edge_weight(f)))
+                             / (degree - 1);
+            }
+        }
+
+        // prefer light nodes to keep the node weights of the coarse graph uniform
+        NodeID best = unmatched;
+        double best_rating = 0.0;
+        for (NodeID v : touched) {
+            double v_rating = rating[v] / G.get_node_weight(v);
+            if (v_rating > best_rating || (v_rating == best_rating && v < best)) {
+                best = v;
+                best_rating = v_rating;
+            }
+            rating[v] = 0.0;
+        }
+        touched.clear();
+
+        if (best != unmatched) {
+            mate[u] = best;
+            mate[best] = u;
+        }
+    }
+
+    map.assign(n, unmatched);
+    NodeID number_of_coarse_nodes = 0;
+    for (NodeID v = 0; v < n; ++v) {
+        if (map[v] != unmatched) {
+            continue;
+        }
+        map[v] = number_of_coarse_nodes;
+        if (mate[v] != unmatched) {
+            map[mate[v]] = number_of_coarse_nodes;
+        }
+        ++number_of_coarse_nodes;
+    }
+
+    return number_of_coarse_nodes;
+}
+
+/**
+ * Contracts {@code finest} until it has at most {@code contraction_limit} data nodes or the matching stops making
+ * progress.
+ *
+ * @param finest
+ * @param contraction_limit
+ * @param maps output: maps[i] maps the data nodes of level i to the data nodes of level i + 1
+ * @return the hierarchy; level 0 is {@code finest}
+ */
+std::vector<weighted_query_graph>
+overlap_coarsener::build_hierarchy(weighted_query_graph finest, NodeID contraction_limit,
+                                   std::vector<std::vector<NodeID>> &maps) {
+    std::vector<weighted_query_graph> hierarchy;
+    hierarchy.push_back(std::move(finest));
+    maps.clear();
+
+    // heavy nodes would make it impossible to find a balanced partition on the coarsest level
+    const NodeID total_weight = hierarchy.front().calculate_partition_weights()[0]
+                                + hierarchy.front().calculate_partition_weights()[1];
+    const NodeID max_node_weight = std::max<NodeID>(2, total_weight / std::max<NodeID>(1, contraction_limit / 2));
+
+    while (hierarchy.back().number_of_data_nodes() > contraction_limit) {
+        std::vector<NodeID> map;
+        NodeID number_of_coarse_nodes = compute_matching(hierarchy.back(), max_node_weight, map);
+
+        // stop if the graph shrinks by less than 5%
+        if (number_of_coarse_nodes > 0.95 * hierarchy.back().number_of_data_nodes()) {
+            break;
+        }
+
+        hierarchy.push_back(hierarchy.back().contract(map, number_of_coarse_nodes));
+        maps.push_back(std::move(map));
+    }
+
+    return hierarchy;
+}
+
+/**
+ * Contracts {@code finest} along an existing hierarchy of a supergraph, e.g. of the graph at the root of the
+ * recursion, instead of computing new matchings. Two data nodes are contracted on a level iff their counterparts are
+ * contracted on that level of the supergraph. Once the levels of the supergraph are used up or stop shrinking
+ * {@code finest}, coarsening continues with new matchings as in {@code build_hierarchy()}.
+ *
+ * @param finest
+ * @param labels labels[data node] = corresponding data node on level 0 of the supergraph hierarchy
+ * @param parent_maps the maps of the supergraph hierarchy
+ * @param contraction_limit
+ * @param maps output: maps[i] maps the data nodes of level i to the data nodes of level i + 1
+ * @return the hierarchy; level 0 is {@code finest}
+ */
+std::vector<weighted_query_graph>
+overlap_coarsener::restrict_hierarchy(weighted_query_graph finest, std::vector<NodeID> labels,
+                                      const std::vector<std::vector<NodeID>> &parent_maps, NodeID contraction_limit,
+                                      std::vector<std::vector<NodeID>> &maps) {
+    assert(labels.size() == finest.number_of_data_nodes());
+
+    std::vector<weighted_query_graph> hierarchy;
+    hierarchy.push_back(std::move(finest));
+    maps.clear();
+
+    for (auto &parent_map : parent_maps) {
+        if (hierarchy.back().number_of_data_nodes() <= contraction_limit) {
+            return hierarchy;
+        }
+
+        // the coarse nodes are the distinct labels on the next level of the supergraph
+        std::vector<NodeID> coarse_labels(labels.size());
+        for (NodeID v = 0; v < labels.size(); ++v) {
+            coarse_labels[v] = parent_map[labels[v]];
+        }
+        labels = coarse_labels;
+        std::sort(coarse_labels.begin(), coarse_labels.end());
+        coarse_labels.erase(std::unique(coarse_labels.begin(), coarse_labels.end()), coarse_labels.end());
+
+        const auto number_of_coarse_nodes = static_cast<NodeID>(coarse_labels.size());
+        if (number_of_coarse_nodes > 0.95 * hierarchy.back().number_of_data_nodes()) {
+            break;
+        }
+
+        std::vector<NodeID> map(labels.size());
+        for (NodeID v = 0; v < labels.size(); ++v) {
+            map[v] = static_cast<NodeID>(std::lower_bound(coarse_labels.begin(), coarse_labels.end(), labels[v])
+                                         - coarse_labels.begin());
+        }
+        labels = std::move(coarse_labels);
+
+        hierarchy.push_back(hierarchy.back().contract(map, number_of_coarse_nodes));
+        maps.push_back(std::move(map));
+    }
+
+    // continue with new matchings on the coarsest restricted level
+    std::vector<std::vector<NodeID>> remaining_maps;
+    auto remaining = build_hierarchy(std::move(hierarchy.back()), contraction_limit, remaining_maps);
+    hierarchy.pop_back();
+    std::move(remaining.begin(), remaining.end(), std::back_inserter(hierarchy));
+    std::move(remaining_maps.begin(), remaining_maps.end(), std::back_inserter(maps));
+
+    return hierarchy;
+}
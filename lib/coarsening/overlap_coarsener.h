@@ -0,0 +1,33 @@
+#ifndef IMPL_OVERLAP_COARSENER_H
+#define IMPL_OVERLAP_COARSENER_H
+
+#include "../data-structure/weighted_query_graph.h"
+
+namespace bathesis {
+
+    /**
+     * Coarsens a {@code weighted_query_graph} by matching pairs of data nodes with a high overlap of their query
+     * neighborhoods.
+     *
+     * Only data nodes of the same partition are matched, hence the partition of the coarse graph is well-defined.
+     */
+    class overlap_coarsener {
+        NodeID m_max_query_degree;
+
+    public:
+        overlap_coarsener(NodeID max_query_degree = 1000);
+
+        NodeID compute_matching(const weighted_query_graph &G, NodeID max_node_weight, std::vector<NodeID> &map);
+
+        std::vector<weighted_query_graph>
+        build_hierarchy(weighted_query_graph finest, NodeID contraction_limit,
+                        std::vector<std::vector<NodeID>> &maps);
+
+        std::vector<weighted_query_graph>
+        restrict_hierarchy(weighted_query_graph finest, std::vector<NodeID> labels,
+                           const std::vector<std::vector<NodeID>> &parent_maps, NodeID contraction_limit,
+                           std::vector<std::vector<NodeID>> &maps);
+    };
+}
+
+#endif // IMPL_OVERLAP_COARSENER_H
@@ -0,0 +1,5 @@
+#include "addressable_heap.h"
+
+using namespace bathesis;
+
+constexpr std::size_t bucket_queue::invalid_position;
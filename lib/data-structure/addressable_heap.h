@@ -0,0 +1,325 @@
+#ifndef IMPL_ADDRESSABLE_HEAP_H
+#define IMPL_ADDRESSABLE_HEAP_H
+
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <data_structure/graph_access.h>
+
+namespace bathesis {
+    /**
+     * Addressable d-ary heap over the elements {@code 0, ..., capacity - 1}.
+     *
+     * The position of every element in the heap is stored in a dense array, hence all operations work without
+     * hashing. With the default comparator, the heap is a max-heap, i.e. {@code top()} returns the element with the
+     * largest key. Keys are stored as given, floating point keys are compared exactly.
+     *
+     * @tparam Key
+     * @tparam Arity number of children per heap node
+     * @tparam Compare strict weak ordering; the element that compares greatest is on top
+     */
+    template<typename Key, std::size_t Arity = 4, typename Compare = std::less<Key>>
+    class addressable_heap {
+        static_assert(Arity >= 2, "heap arity must be at least 2");
+
+        static constexpr std::size_t invalid_position = std::numeric_limits<std::size_t>::max();
+
+        std::vector<std::pair<Key, NodeID>> m_heap;
+        std::vector<std::size_t> m_position; // m_position[element] = index in m_heap or invalid_position
+        Compare m_compare;
+
+        void sift_up(std::size_t pos);
+
+        void sift_down(std::size_t pos);
+
+        void place(std::size_t pos, const std::pair<Key, NodeID> &entry) {
+            m_heap[pos] = entry;
+            m_position[entry.second] = pos;
+        }
+
+    public:
+        explicit addressable_heap(std::size_t capacity = 0, Compare compare = Compare())
+                : m_position(capacity, invalid_position), m_compare(compare) {
+        }
+
+        /**
+         * Removes all elements and sets the capacity.
+         *
+         * @param capacity
+         */
+        void reset(std::size_t capacity) {
+            m_heap.clear();
+            m_position.assign(capacity, invalid_position);
+        }
+
+        /**
+         * Replaces the content of the heap by the given (key, element) pairs in O(n).
+         *
+         * @param entries
+         */
+        void build(std::vector<std::pair<Key, NodeID>> entries);
+
+        std::size_t size() const {
+            return m_heap.size();
+        }
+
+        bool empty() const {
+            return m_heap.empty();
+        }
+
+        bool contains(NodeID element) const {
+            return m_position[element] != invalid_position;
+        }
+
+        NodeID top() const {
+            assert(!empty());
+            return m_heap.front().second;
+        }
+
+        const Key &top_key() const {
+            assert(!empty());
+            return m_heap.front().first;
+        }
+
+        const Key &get_key(NodeID element) const {
+            assert(contains(element));
+            return m_heap[m_position[element]].first;
+        }
+
+        void insert(NodeID element, Key key);
+
+        NodeID pop();
+
+        void remove(NodeID element);
+
+        void change_key(NodeID element, Key key);
+    };
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    constexpr std::size_t addressable_heap<Key, Arity, Compare>::invalid_position;
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::sift_up(std::size_t pos) {
+        auto entry = m_heap[pos];
+        while (pos > 0) {
+            std::size_t parent = (pos - 1) / Arity;
+            if (!m_compare(m_heap[parent].first, entry.first)) {
+                break;
+            }
+            place(pos, m_heap[parent]);
+            pos = parent;
+        }
+        place(pos, entry);
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::sift_down(std::size_t pos) {
+        auto entry = m_heap[pos];
+        while (true) {
+            std::size_t first_child = Arity * pos + 1;
+            if (first_child >= m_heap.size()) {
+                break;
+            }
+
+            std::size_t last_child = std::min(first_child + Arity, m_heap.size());
+            std::size_t max_child = first_child;
+            for (std::size_t child = first_child + 1; child < last_child; ++child) {
+                if (m_compare(m_heap[max_child].first, m_heap[child].first)) {
+                    max_child = child;
+                }
+            }
+
+            if (!m_compare(entry.first, m_heap[max_child].first)) {
+                break;
+            }
+            place(pos, m_heap[max_child]);
+            pos = max_child;
+        }
+        place(pos, entry);
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::build(std::vector<std::pair<Key, NodeID>> entries) {
+        for (auto &entry : m_heap) {
+            m_position[entry.second] = invalid_position;
+        }
+
+        m_heap = std::move(entries);
+        for (std::size_t pos = 0; pos < m_heap.size(); ++pos) {
+            assert(m_position[m_heap[pos].second] == invalid_position);
+            m_position[m_heap[pos].second] = pos;
+        }
+
+        // Floyd's bottom-up heap construction
+        if (m_heap.size() > 1) {
+            for (std::size_t pos = (m_heap.size() - 2) / Arity + 1; pos-- > 0;) {
+                sift_down(pos);
+            }
+        }
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::insert(NodeID element, Key key) {
+        assert(element < m_position.size());
+        assert(!contains(element));
+
+        m_heap.emplace_back(key, element);
+        m_position[element] = m_heap.size() - 1;
+        sift_up(m_heap.size() - 1);
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    NodeID addressable_heap<Key, Arity, Compare>::pop() {
+        NodeID element = top();
+        remove(element);
+        return element;
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::remove(NodeID element) {
+        assert(contains(element));
+
+        std::size_t pos = m_position[element];
+        m_position[element] = invalid_position;
+
+        auto last = m_heap.back();
+        m_heap.pop_back();
+        if (pos == m_heap.size()) {
+            return;
+        }
+
+        // the last entry takes the place of the removed one and moves into the right direction
+        bool move_up = m_compare(m_heap[pos].first, last.first);
+        place(pos, last);
+        if (move_up) {
+            sift_up(pos);
+        } else {
+            sift_down(pos);
+        }
+    }
+
+    template<typename Key, std::size_t Arity, typename Compare>
+    void addressable_heap<Key, Arity, Compare>::change_key(NodeID element, Key key) {
+        assert(contains(element));
+
+        std::size_t pos = m_position[element];
+        bool move_up = m_compare(m_heap[pos].first, key);
+        m_heap[pos].first = key;
+        if (move_up) {
+            sift_up(pos);
+        } else {
+            sift_down(pos);
+        }
+    }
+
+    template<typename Key, std::size_t Arity = 4>
+    using max_heap = addressable_heap<Key, Arity, std::less<Key>>;
+
+    template<typename Key, std::size_t Arity = 4>
+    using min_heap = addressable_heap<Key, Arity, std::greater<Key>>;
+
+    /**
+     * Addressable max-priority queue for integer keys in a fixed range {@code [min_key, max_key]}.
+     *
+     * Every key has a bucket. All operations take constant time, except {@code top()} and {@code pop()}, which scan
+     * down to the next nonempty bucket; this is cheap as long as keys change by small amounts.
+     */
+    class bucket_queue {
+        static constexpr std::size_t invalid_position = std::numeric_limits<std::size_t>::max();
+
+        long m_min_key;
+        std::vector<std::vector<NodeID>> m_buckets;
+        std::vector<long> m_keys;
+        std::vector<std::size_t> m_position; // m_position[element] = index in its bucket or invalid_position
+        std::size_t m_size = 0;
+        std::size_t m_max_bucket = 0;
+
+        std::size_t bucket_of(long key) const {
+            assert(m_min_key <= key && key < m_min_key + static_cast<long>(m_buckets.size()));
+            return static_cast<std::size_t>(key - m_min_key);
+        }
+
+        void update_max_bucket() {
+            while (m_max_bucket > 0 && m_buckets[m_max_bucket].empty()) {
+                --m_max_bucket;
+            }
+        }
+
+    public:
+        bucket_queue(std::size_t capacity, long min_key, long max_key)
+                : m_min_key(min_key),
+                  m_buckets(static_cast<std::size_t>(max_key - min_key + 1)),
+                  m_keys(capacity, 0),
+                  m_position(capacity, invalid_position) {
+            assert(min_key <= max_key);
+        }
+
+        std::size_t size() const {
+            return m_size;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        bool contains(NodeID element) const {
+            return m_position[element] != invalid_position;
+        }
+
+        long get_key(NodeID element) const {
+            assert(contains(element));
+            return m_keys[element];
+        }
+
+        NodeID top() {
+            assert(!empty());
+            update_max_bucket();
+            return m_buckets[m_max_bucket].back();
+        }
+
+        long top_key() {
+            return get_key(top());
+        }
+
+        void insert(NodeID element, long key) {
+            assert(!contains(element));
+
+            auto &bucket = m_buckets[bucket_of(key)];
+            m_keys[element] = key;
+            m_position[element] = bucket.size();
+            bucket.push_back(element);
+
+            m_max_bucket = std::max(m_max_bucket, bucket_of(key));
+            ++m_size;
+        }
+
+        void remove(NodeID element) {
+            assert(contains(element));
+
+            auto &bucket = m_buckets[bucket_of(m_keys[element])];
+            std::size_t pos = m_position[element];
+            bucket[pos] = bucket.back();
+            m_position[bucket[pos]] = pos;
+            bucket.pop_back();
+
+            m_position[element] = invalid_position;
+            --m_size;
+        }
+
+        NodeID pop() {
+            NodeID element = top();
+            remove(element);
+            return element;
+        }
+
+        void change_key(NodeID element, long key) {
+            remove(element);
+            insert(element, key);
+        }
+    };
+}
+
+#endif // IMPL_ADDRESSABLE_HEAP_H
@@ -0,0 +1,26 @@
+#include "compressed_adjacency.h"
+
+using namespace bathesis;
+
+constexpr NodeID compressed_adjacency::block_size;
+
+/**
+ * Encodes the adjacency lists of a CSR graph. The order of the neighbors in a list is not kept, lists are sorted.
+ *
+ * @param first_edge first_edge[node] = first edge id of node, with one extra entry for the end of the last list
+ * @param targets targets[edge id] = neighbor
+ */
+void compressed_adjacency::encode(const numa_vector<EdgeID> &first_edge, const numa_vector<NodeID> &targets) {
+    assert(!first_edge.empty());
+    encode(static_cast<NodeID>(first_edge.size() - 1), [&](NodeID node, std::vector<NodeID> &list) {
+        list.insert(list.end(), targets.begin() + first_edge[node], targets.begin() + first_edge[node + 1]);
+    });
+}
+
+/**
+ * @return bytes used by the lists and the offset index
+ */
+std::size_t compressed_adjacency::memory_size() const {
+    return m_bytes.size() + m_node_offsets.size() * sizeof(std::uint32_t)
+           + m_block_offsets.size() * sizeof(std::uint64_t);
+}
@@ -0,0 +1,296 @@
+#ifndef IMPL_COMPRESSED_ADJACENCY_H
+#define IMPL_COMPRESSED_ADJACENCY_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include <data_structure/graph_access.h>
+
+#include "numa_allocator.h"
+
+namespace bathesis {
+    namespace varint {
+        /**
+         * Appends {@code value} in little endian base 128, i.e. 7 bits per byte with the highest bit set on all bytes
+         * but the last.
+         *
+         * @param value
+         * @param bytes
+         */
+        inline void encode(std::uint64_t value, std::vector<std::uint8_t> &bytes) {
+            while (value >= 0x80) {
+                bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        /**
+         * Writes {@code value} like {@code encode(value, bytes)} to the given position.
+         *
+         * @param value
+         * @param position
+         * @return the position after the value
+         */
+        inline std::uint8_t *encode(std::uint64_t value, std::uint8_t *position) {
+            while (value >= 0x80) {
+                *position++ = static_cast<std::uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            *position++ = static_cast<std::uint8_t>(value);
+            return position;
+        }
+
+        /**
+         * @param value
+         * @return number of bytes of the encoded value
+         */
+        inline std::size_t size(std::uint64_t value) {
+            std::size_t bytes = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                ++bytes;
+            }
+            return bytes;
+        }
+
+        /**
+         * Decodes the value at {@code bytes} and advances {@code bytes} past it.
+         *
+         * @param bytes
+         * @return
+         */
+        inline std::uint64_t decode(const std::uint8_t *&bytes) {
+            std::uint64_t value = *bytes & 0x7f;
+            for (unsigned shift = 7; *bytes++ & 0x80; shift += 7) {
+                value |= static_cast<std::uint64_t>(*bytes & 0x7f) << shift;
+            }
+            return value;
+        }
+    }
+
+    /**
+     * Node ids in an adjacency list of a query graph, e.g. the neighbors of a node, stored either as a plain array
+     * or gap encoded, see {@code compressed_adjacency}. Iterating a range does not allocate; the range is invalidated
+     * when the graph is reconstructed.
+     */
+    class node_range {
+    public:
+        class iterator {
+            const NodeID *m_position;    // next plain node id
+            const std::uint8_t *m_bytes; // next gap, nullptr for plain lists
+            std::size_t m_remaining;
+            NodeID m_value;
+
+            void load() {
+                if (m_remaining == 0) {
+                    return;
+                }
+                if (m_bytes == nullptr) {
+                    m_value = *m_position++;
+                } else {
+                    m_value += static_cast<NodeID>(varint::decode(m_bytes));
+                }
+            }
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = NodeID;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const NodeID *;
+            using reference = NodeID;
+
+            iterator(const NodeID *position, const std::uint8_t *bytes, std::size_t remaining)
+                    : m_position(position), m_bytes(bytes), m_remaining(remaining), m_value(0) {
+                load();
+            }
+
+            NodeID operator*() const {
+                assert(m_remaining > 0);
+                return m_value;
+            }
+
+            iterator &operator++() {
+                assert(m_remaining > 0);
+                --m_remaining;
+                load();
+                return *this;
+            }
+
+            // only iterators of the same range are compared
+            bool operator==(const iterator &other) const {
+                return m_remaining == other.m_remaining;
+            }
+
+            bool operator!=(const iterator &other) const {
+                return m_remaining != other.m_remaining;
+            }
+        };
+
+    private:
+        const NodeID *m_position;
+        const std::uint8_t *m_bytes;
+        std::size_t m_size;
+
+    public:
+        node_range(const NodeID *first, const NodeID *last)
+                : m_position(first), m_bytes(nullptr), m_size(static_cast<std::size_t>(last - first)) {
+        }
+
+        node_range(const std::uint8_t *bytes, std::size_t size) : m_position(nullptr), m_bytes(bytes), m_size(size) {
+        }
+
+        iterator begin() const {
+            return iterator(m_position, m_bytes, m_size);
+        }
+
+        iterator end() const {
+            return iterator(nullptr, nullptr, 0);
+        }
+
+        std::size_t size() const {
+            return m_size;
+        }
+
+        bool empty() const {
+            return m_size == 0;
+        }
+    };
+
+    /**
+     * Read-only adjacency lists in a byte array. Every list is sorted and stored as its length followed by the gaps
+     * between consecutive node ids (the first gap is the first node id), each as a varint. An offset index gives the
+     * first byte of every list: a 64 bit base per block of nodes plus a 32 bit offset per node relative to the base.
+     *
+     * For graphs with small gaps, i.e. graphs in a good order, most gaps take one byte instead of four.
+     *
+     * The lists are encoded in two passes over the input, one for the sizes and one that writes them into the final
+     * array, hence the input does not have to be stored as CSR arrays and no intermediate buffers are needed.
+     */
+    class compressed_adjacency {
+        static constexpr NodeID block_size = 256;
+
+        std::vector<std::uint64_t> m_block_offsets; // m_block_offsets[block] = first byte of the block
+        std::vector<std::uint32_t> m_node_offsets;  // m_node_offsets[node] = first byte of the node in its block
+        numa_vector<std::uint8_t> m_bytes;
+        EdgeID m_number_of_edges = 0;
+
+        const std::uint8_t *list(NodeID node) const {
+            assert(node < number_of_nodes());
+            return m_bytes.data() + m_block_offsets[node / block_size] + m_node_offsets[node];
+        }
+
+    public:
+        template<typename Neighbors>
+        void encode(NodeID num_nodes, Neighbors neighbors);
+
+        void encode(const numa_vector<EdgeID> &first_edge, const numa_vector<NodeID> &targets);
+
+        NodeID number_of_nodes() const {
+            return static_cast<NodeID>(m_node_offsets.size());
+        }
+
+        EdgeID number_of_edges() const {
+            return m_number_of_edges;
+        }
+
+        std::size_t degree(NodeID node) const {
+            const std::uint8_t *bytes = list(node);
+            return static_cast<std::size_t>(varint::decode(bytes));
+        }
+
+        node_range neighbors(NodeID node) const {
+            const std::uint8_t *bytes = list(node);
+            auto size = static_cast<std::size_t>(varint::decode(bytes));
+            return {bytes, size};
+        }
+
+        std::size_t memory_size() const;
+    };
+
+    /**
+     * Encodes the adjacency lists given by a function. The order of the neighbors in a list is not kept, lists are
+     * sorted. The function is called twice per node, possibly in parallel for different nodes.
+     *
+     * @tparam Neighbors
+     * @param num_nodes
+     * @param neighbors {@code neighbors(node, list)} appends the neighbors of node to list
+     */
+    template<typename Neighbors>
+    void compressed_adjacency::encode(NodeID num_nodes, Neighbors neighbors) {
+        const NodeID num_blocks = (num_nodes + block_size - 1) / block_size;
+
+        m_node_offsets.resize(num_nodes);
+        m_block_offsets.assign(num_blocks + 1, 0);
+        EdgeID num_edges = 0;
+
+        // Step 1: Sizes of the lists, relative to the first list of their block
+#pragma omp parallel
+        {
+            std::vector<NodeID> list;
+
+#pragma omp for schedule(dynamic, 16) reduction(+: num_edges)
+            for (NodeID block = 0; block < num_blocks; ++block) {
+                NodeID last_node = std::min(num_nodes, (block + 1) * block_size);
+                std::size_t block_bytes = 0;
+
+                for (NodeID node = block * block_size; node < last_node; ++node) {
+                    assert(block_bytes <= std::numeric_limits<std::uint32_t>::max());
+                    m_node_offsets[node] = static_cast<std::uint32_t>(block_bytes);
+
+                    list.clear();
+                    neighbors(node, list);
+                    std::sort(list.begin(), list.end());
+                    num_edges += list.size();
+
+                    block_bytes += varint::size(list.size());
+                    NodeID previous = 0;
+                    for (NodeID neighbor : list) {
+                        block_bytes += varint::size(neighbor - previous);
+                        previous = neighbor;
+                    }
+                }
+                m_block_offsets[block + 1] = block_bytes;
+            }
+        }
+
+        for (NodeID block = 0; block < num_blocks; ++block) {
+            m_block_offsets[block + 1] += m_block_offsets[block];
+        }
+        m_number_of_edges = num_edges;
+        m_bytes.resize(m_block_offsets[num_blocks]);
+
+        // Step 2: Write the lists
+#pragma omp parallel
+        {
+            std::vector<NodeID> list;
+
+#pragma omp for schedule(dynamic, 16)
+            for (NodeID block = 0; block < num_blocks; ++block) {
+                NodeID last_node = std::min(num_nodes, (block + 1) * block_size);
+                std::uint8_t *position = m_bytes.data() + m_block_offsets[block];
+
+                for (NodeID node = block * block_size; node < last_node; ++node) {
+                    list.clear();
+                    neighbors(node, list);
+                    std::sort(list.begin(), list.end());
+
+                    position = varint::encode(list.size(), position);
+                    NodeID previous = 0;
+                    for (NodeID neighbor : list) {
+                        position = varint::encode(neighbor - previous, position);
+                        previous = neighbor;
+                    }
+                }
+                assert(position == m_bytes.data() + m_block_offsets[block + 1]);
+            }
+        }
+    }
+}
+
+#endif // IMPL_COMPRESSED_ADJACENCY_H
@@ -0,0 +1,87 @@
+#include "numa_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <omp.h>
+
+using namespace bathesis;
+
+namespace {
+    constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+    std::size_t mapped_size(std::size_t bytes) {
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+
+    /**
+     * Touches the pages of the array in contiguous blocks of elements, one per thread, like a loop with
+     * {@code schedule(static)}.
+     */
+    void first_touch(void *pointer, std::size_t bytes, std::size_t element_size) {
+        auto *first = static_cast<char *>(pointer);
+        const std::size_t n = bytes / element_size;
+
+#pragma omp parallel
+        {
+            const auto threads = static_cast<std::size_t>(omp_get_num_threads());
+            const auto thread = static_cast<std::size_t>(omp_get_thread_num());
+            const std::size_t block = (n + threads - 1) / threads;
+            const std::size_t begin = std::min(n, thread * block);
+            const std::size_t end = std::min(n, begin + block);
+            std::memset(first + begin * element_size, 0, (end - begin) * element_size);
+        }
+    }
+}
+
+page_allocation::options &page_allocation::global_options() {
+    static options instance;
+    return instance;
+}
+
+void *page_allocation::allocate(std::size_t bytes, std::size_t element_size) {
+#ifdef __linux__
+    if (bytes >= huge_page_size) {
+        const std::size_t size = mapped_size(bytes);
+        void *pointer = MAP_FAILED;
+
+        if (global_options().explicit_huge_pages) {
+            pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (pointer == MAP_FAILED) { // no reserved huge pages left, fall back to transparent ones
+            pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (pointer == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            madvise(pointer, size, MADV_HUGEPAGE);
+        }
+
+        if (global_options().interleave) {
+            // MPOL_INTERLEAVE over all nodes; the kernel drops nodes without memory, failures keep the default
+            const int interleave = 3;
+            unsigned long nodes = ~0UL;
+            syscall(SYS_mbind, pointer, size, interleave, &nodes, sizeof(nodes) * 8, 0);
+        }
+
+        first_touch(pointer, bytes, element_size);
+        return pointer;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+void page_allocation::deallocate(void *pointer, std::size_t bytes) {
+#ifdef __linux__
+    if (bytes >= huge_page_size) {
+        munmap(pointer, mapped_size(bytes));
+        return;
+    }
+#endif
+    ::operator delete(pointer);
+}
@@ -0,0 +1,75 @@
+#ifndef IMPL_NUMA_ALLOCATOR_H
+#define IMPL_NUMA_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace bathesis {
+    namespace page_allocation {
+        /**
+         * Page placement of large arrays, see {@code numa_allocator}. Set before the graph is loaded; arrays that
+         * are already allocated keep their placement.
+         */
+        struct options {
+            bool interleave = false;          // spread the pages round robin over all NUMA nodes
+            bool explicit_huge_pages = false; // use reserved huge pages if available, not transparent ones
+        };
+
+        options &global_options();
+
+        void *allocate(std::size_t bytes, std::size_t element_size);
+
+        void deallocate(void *pointer, std::size_t bytes);
+    }
+
+    /**
+     * Allocator for the large arrays of the graphs and the refiners, e.g. CSR, partition and gain arrays.
+     *
+     * Arrays of at least one huge page are mapped separately and backed by huge pages. Their pages are touched in
+     * parallel before they are returned: thread i touches the i-th contiguous block of elements, i.e. the elements
+     * that a {@code schedule(static)} loop over the array assigns to it, hence under the first touch policy of Linux
+     * each page is placed on the NUMA node of the thread that reads it later. Loops with a dynamic schedule get the
+     * pages spread over all nodes instead of on the node of the thread that filled the array. Optionally, pages are
+     * interleaved over all nodes, see {@code page_allocation::options}. Smaller arrays use the default allocator.
+     *
+     * @tparam T
+     */
+    template<typename T>
+    class numa_allocator {
+    public:
+        using value_type = T;
+
+        numa_allocator() = default;
+
+        template<typename U>
+        numa_allocator(const numa_allocator<U> &) {
+        }
+
+        T *allocate(std::size_t n) {
+            if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(page_allocation::allocate(n * sizeof(T), sizeof(T)));
+        }
+
+        void deallocate(T *pointer, std::size_t n) {
+            page_allocation::deallocate(pointer, n * sizeof(T));
+        }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const numa_allocator<T> &, const numa_allocator<U> &) {
+        return true;
+    }
+
+    template<typename T, typename U>
+    bool operator!=(const numa_allocator<T> &, const numa_allocator<U> &) {
+        return false;
+    }
+
+    template<typename T>
+    using numa_vector = std::vector<T, numa_allocator<T>>;
+}
+
+#endif // IMPL_NUMA_ALLOCATOR_H
@@ -1,33 +1,90 @@
 #include "query_graph.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
 using namespace bathesis;
 
+namespace {
+    std::atomic<std::uint64_t> next_graph_id(1);
+}
+
 query_graph::query_graph() {
     m_is_constructing = false;
     m_last_source_id = 0;
     m_parent = this;
+    m_is_compressed = false;
+    m_is_symmetric = false;
+    m_storage = nullptr;
+    m_branch_id = 1;
+    m_graph_id = 0;
 }
 
-void query_graph::construct_query_edges() {
+/**
+ * Constructs a query node for every data node of the data graph whose neighbors are the data neighbors of the data
+ * node. Both directions are the same, hence only the query side is stored, with every list in ascending order.
+ *
+ * @param compressed encode the adjacency directly from the data graph instead of building the CSR arrays and
+ * compressing them afterwards, see {@code compress()}
+ */
+void query_graph::construct_query_edges(bool compressed) {
+    assert(m_parent == this);
+    graph_access &G = *m_data_graph;
+    m_graph_id = next_graph_id++;
+
+    if (compressed) {
+        assert(!m_is_compressed);
+        initialize_partition();
+        m_compressed_query_edges.encode(G.number_of_nodes(), [&G](NodeID node_id, std::vector<NodeID> &list) {
+            forall_out_edges(G, edge_id, node_id)
+                    list.push_back(G.getEdgeTarget(edge_id));
+            endfor
+        });
+        m_is_compressed = true;
+        m_is_symmetric = true;
+        return;
+    }
+
     start_construction();
 
-    forall_nodes(m_data_graph, node_id)
-            forall_out_edges(m_data_graph, edge_id, node_id)
-                    NodeID neighbor_id = m_data_graph.getEdgeTarget(edge_id);
+    forall_nodes(G, node_id)
+            forall_out_edges(G, edge_id, node_id)
+                    NodeID neighbor_id = G.getEdgeTarget(edge_id);
                     add_query_edge(node_id, neighbor_id);
             endfor
     endfor
 
+    m_is_symmetric = true;
     finish_construction();
 }
 
+/**
+ * Reads the partition of the root graph from the partition indices of its data graph.
+ */
+void query_graph::initialize_partition() {
+    assert(m_parent == this);
+    graph_access &G = *m_data_graph;
+
+    m_partition.resize(G.number_of_nodes());
+    forall_nodes(G, node_id)
+            m_partition[node_id] = static_cast<std::uint8_t>(G.getPartitionIndex(node_id));
+    endfor
+}
+
 void query_graph::start_construction() {
-    start_construction(m_data_graph.number_of_nodes());
+    start_construction(m_data_graph->number_of_nodes());
 }
 
 void query_graph::start_construction(NodeID number_of_query_nodes) {
-    assert(number_of_query_nodes >= m_data_graph.number_of_nodes());
     assert(!m_is_constructing);
+    assert(!m_is_compressed);
+
+    // the data nodes of a subgraph are set up by the graph that builds it
+    if (m_parent == this) {
+        initialize_partition();
+    }
+    assert(number_of_query_nodes >= number_of_data_nodes());
 
     m_is_constructing = true;
     m_query_nodes.resize(number_of_query_nodes + 1);
@@ -36,7 +93,7 @@ void query_graph::start_construction(NodeID number_of_query_nodes) {
 void query_graph::add_query_edge(NodeID source_id, NodeID target_id) {
     assert(m_is_constructing);
     assert(source_id < number_of_query_nodes());
-    assert(target_id < m_data_graph.number_of_nodes());
+    assert(target_id < number_of_data_nodes());
     assert(m_last_source_id <= source_id);
 
     m_query_edges.push_back(target_id);
@@ -60,103 +117,302 @@ void query_graph::finish_construction() {
         }
     }
 
+    if (m_is_symmetric) {
+        // the query side doubles as data side, whose lists have to be sorted
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeID node_id = 0; node_id < number_of_query_nodes(); ++node_id) {
+            std::sort(m_query_edges.begin() + m_query_nodes[node_id],
+                      m_query_edges.begin() + m_query_nodes[node_id + 1]);
+        }
+    } else {
+        build_data_edges();
+    }
     m_is_constructing = false;
 }
 
-std::array<std::vector<NodeID>, 2>
-query_graph::build_partition_induced_subgraphs(std::array<query_graph, 2> &subgraphs) {
-    std::array<NodeID, 2> number_of_data_nodes = {0, 0};
-    std::array<EdgeID, 2> number_of_data_edges = {0, 0};
-
-    // Step 1: Count the number of data nodes and edges in each partition
-    forall_nodes(m_data_graph, node_id)
-            PartitionID partition_id = m_data_graph.getPartitionIndex(node_id);
-            ++number_of_data_nodes[partition_id];
-
-            forall_out_edges(m_data_graph, edge_id, node_id)
-                    NodeID neighbor_id = m_data_graph.getEdgeTarget(edge_id);
-                    if (partition_id == m_data_graph.getPartitionIndex(neighbor_id)) {
-                        ++number_of_data_edges[partition_id];
-                    }
-            endfor
-    endfor
+/**
+ * Transposes the query edges, i.e. builds the query neighbors of every data node. Query nodes are visited in
+ * ascending order, hence the query neighbors of every data node are sorted.
+ */
+void query_graph::build_data_edges() {
+    const NodeID num_data_nodes = number_of_data_nodes();
 
-    // Step 2: Construct the data graphs
-    // When we construct new data graphs, the node ids change as the number of nodes reduces in both subgraphs
+    m_data_nodes.assign(num_data_nodes + 1, 0);
+    for (NodeID target : m_query_edges) {
+        ++m_data_nodes[target + 1];
+    }
+    for (NodeID v = 0; v < num_data_nodes; ++v) {
+        m_data_nodes[v + 1] += m_data_nodes[v];
+    }
+
+    m_data_edges.resize(m_query_edges.size());
+    std::vector<EdgeID> next_edge(m_data_nodes.begin(), m_data_nodes.end() - 1);
+    for (NodeID node_id = 0; node_id < number_of_query_nodes(); ++node_id) {
+        for (EdgeID edge_id = m_query_nodes[node_id]; edge_id < m_query_nodes[node_id + 1]; ++edge_id) {
+            m_data_edges[next_edge[m_query_edges[edge_id]]++] = node_id;
+        }
+    }
+}
+
+/**
+ * Builds the subgraphs induced by both partitions. Their CSR arrays are lent by {@code storage}, see
+ * {@code release_storage()}.
+ *
+ * @param subgraphs
+ * @param storage
+ * @return map_new_to_old[partition][subgraph data node] = data node of this graph
+ */
+std::array<std::vector<NodeID>, 2>
+query_graph::build_partition_induced_subgraphs(std::array<query_graph, 2> &subgraphs, subgraph_storage &storage) {
+    // Step 1: Count the number of data nodes in each partition and construct the map arrays
+    // When we construct new graphs, the node ids change as the number of nodes reduces in both subgraphs
     // These vectors are used to keep track of those changes
-    std::vector<NodeID> map_old_to_new(m_data_graph.number_of_nodes()); // map_old_to_new[old id] = new id
-    std::array<std::vector<NodeID>, 2> map_new_to_old = {               // map_new_to_old[partition][new id] = old id
-            std::vector<NodeID>(number_of_data_nodes[0]),
-            std::vector<NodeID>(number_of_data_nodes[1])
-    };
-    for (int i = 0; i < 2; ++i) {
-        subgraphs[i].data_graph().start_construction(number_of_data_nodes[i], number_of_data_edges[i]);
-        subgraphs[i].start_construction(number_of_query_nodes());
+    std::vector<NodeID> map_old_to_new(number_of_data_nodes()); // map_old_to_new[old id] = new id
+    std::array<std::vector<NodeID>, 2> map_new_to_old;          // map_new_to_old[partition][new id] = old id
+    std::array<EdgeID, 2> partition_edges = {0, 0};
+    for (NodeID node_id = 0; node_id < number_of_data_nodes(); ++node_id) {
+        PartitionID partition_id = get_partition(node_id);
+        map_old_to_new[node_id] = static_cast<NodeID>(map_new_to_old[partition_id].size());
+        map_new_to_old[partition_id].push_back(node_id);
+        partition_edges[partition_id] += get_number_of_adjacent_query_nodes(node_id);
     }
 
-    // Step 2.1: Construct the induced data graphs
-    // Step 2.1.1: Construct the map arrays, i.e. the translation from new to old ids and vice versa
-    forall_nodes(m_data_graph, node_id)
-            PartitionID partition_id = m_data_graph.getPartitionIndex(node_id);
+    // Step 2: Add the edges between query and data nodes respecting the new node ids
+    // The data graphs of the subgraphs are only materialized on demand, see data_graph()
+    // The subgraphs are built one after the other, hence only one of them is uncompressed at a time
+    for (PartitionID i = 0; i < 2; ++i) {
+        subgraphs[i].m_parent = this;
+        subgraphs[i].m_data_graph.reset();
+        subgraphs[i].m_map_to_parent = map_new_to_old[i];
+        subgraphs[i].m_partition.assign(map_new_to_old[i].size(), 0);
+        subgraphs[i].m_branch_id = 2 * m_branch_id + i;
+        subgraphs[i].acquire_storage(m_is_compressed ? storage.scratch() : storage.slot(subgraphs[i].m_branch_id));
+        subgraphs[i].m_query_edges.reserve(partition_edges[i]);
+        subgraphs[i].start_construction(number_of_query_nodes());
 
-            NodeID new_node_id = subgraphs[partition_id].data_graph().new_node();
-            subgraphs[partition_id].data_graph().setPartitionIndex(new_node_id, 0);
-            subgraphs[partition_id].data_graph().setNodeWeight(new_node_id, 1);
+        for (NodeID node_id = 0; node_id < number_of_query_nodes(); ++node_id) {
+            for (NodeID neighbor_id : get_adjacent_data_nodes(node_id)) {
+                if (get_partition(neighbor_id) == i) {
+                    subgraphs[i].add_query_edge(node_id, map_old_to_new[neighbor_id]);
+                }
+            }
+        }
 
-            map_old_to_new[node_id] = new_node_id;
-            map_new_to_old[partition_id][new_node_id] = node_id;
+        subgraphs[i].finish_construction();
+        if (m_is_compressed) {
+            subgraphs[i].compress();
+        }
+    }
 
-            assert(new_node_id < number_of_data_nodes[partition_id]);
-    endfor
+    // Validate result with some basic sanity checks
+    assert(number_of_query_nodes() == subgraphs[0].number_of_query_nodes());
+    assert(number_of_query_nodes() == subgraphs[1].number_of_query_nodes());
+    assert(number_of_query_edges() == subgraphs[0].number_of_query_edges() + subgraphs[1].number_of_query_edges());
+    assert(number_of_data_nodes() == subgraphs[0].number_of_data_nodes() + subgraphs[1].number_of_data_nodes());
+
+    return map_new_to_old;
+}
 
-    // Step 2.1.2: Actual graph construction
-    forall_nodes(m_data_graph, node_id)
-            PartitionID partition_id = m_data_graph.getPartitionIndex(node_id);
+/**
+ * Builds the graph in which every cluster of data nodes of this graph is contracted to a single data node, e.g. to
+ * bisect a sample of this graph without losing its connectivity. The contracted graph is a root graph: it owns its
+ * data graph, with the size of a cluster as node weight and the number of data edges between two clusters as edge
+ * weight, and it has one query node per contracted data node, see {@code construct_query_edges()}. It keeps the
+ * branch id of this graph.
+ *
+ * @param cluster cluster[data node] = cluster of the data node, {@code number_of_clusters} to leave it out
+ * @param number_of_clusters
+ * @param contracted an empty graph
+ */
+void query_graph::build_contracted_graph(const std::vector<NodeID> &cluster, NodeID number_of_clusters,
+                                         query_graph &contracted) {
+    assert(cluster.size() == number_of_data_nodes());
+    assert(contracted.number_of_data_nodes() == 0);
+
+    // members of each cluster
+    std::vector<EdgeID> first_member(number_of_clusters + 1, 0);
+    for (NodeID v = 0; v < number_of_data_nodes(); ++v) {
+        if (cluster[v] < number_of_clusters) {
+            ++first_member[cluster[v] + 1];
+        }
+    }
+    for (NodeID c = 0; c < number_of_clusters; ++c) {
+        first_member[c + 1] += first_member[c];
+    }
 
-            forall_out_edges(m_data_graph, edge_id, node_id)
-                    NodeID neighbor_id = m_data_graph.getEdgeTarget(edge_id);
+    std::vector<NodeID> members(first_member[number_of_clusters]);
+    {
+        std::vector<EdgeID> next_member(first_member.begin(), first_member.end() - 1);
+        for (NodeID v = 0; v < number_of_data_nodes(); ++v) {
+            if (cluster[v] < number_of_clusters) {
+                members[next_member[cluster[v]]++] = v;
+            }
+        }
+    }
 
-                    // Omit cut edges in the data graph; we will add them between query and data nodes
-                    if (partition_id != m_data_graph.getPartitionIndex(neighbor_id)) {
-                        continue;
+    // Step 1: Merge the data edges of the members of every cluster; the data neighbors of a data node are the
+    // neighbors of its query node, see construct_query_edges()
+    std::vector<std::vector<std::pair<NodeID, EdgeWeight>>> edges(number_of_clusters);
+
+#pragma omp parallel
+    {
+        std::vector<EdgeWeight> weights(number_of_clusters, 0);
+        std::vector<NodeID> targets;
+
+#pragma omp for schedule(dynamic, 64)
+        for (NodeID c = 0; c < number_of_clusters; ++c) {
+            for (EdgeID i = first_member[c]; i < first_member[c + 1]; ++i) {
+                for (NodeID neighbor_id : get_adjacent_data_nodes(get_root_data_node(members[i]))) {
+                    NodeID d = cluster[neighbor_id];
+                    if (d < number_of_clusters && d != c && weights[d]++ == 0) {
+                        targets.push_back(d);
                     }
+                }
+            }
+
+            std::sort(targets.begin(), targets.end());
+            edges[c].reserve(targets.size());
+            for (NodeID d : targets) {
+                edges[c].emplace_back(d, weights[d]);
+                weights[d] = 0;
+            }
+            targets.clear();
+        }
+    }
 
-                    EdgeID new_edge_id = subgraphs[partition_id].data_graph().new_edge(
-                            map_old_to_new[node_id],
-                            map_old_to_new[neighbor_id]
-                    );
-                    subgraphs[partition_id].data_graph().setEdgeWeight(new_edge_id, 1);
-            endfor
-    endfor
+    // Step 2: Construct the contracted data graph and its query nodes
+    EdgeID number_of_contracted_edges = 0;
+    for (auto &cluster_edges : edges) {
+        number_of_contracted_edges += cluster_edges.size();
+    }
 
-    // Step 3: Add the edges between query and data nodes respecting the new node ids
-    for (NodeID node_id = 0; node_id < number_of_query_nodes(); ++node_id) {
-        for (EdgeID edge_id = m_query_nodes[node_id]; edge_id < m_query_nodes[node_id + 1]; ++edge_id) {
-            NodeID neighbor_id = m_query_edges[edge_id];
-            PartitionID partition_id = m_data_graph.getPartitionIndex(neighbor_id);
-            subgraphs[partition_id].add_query_edge(node_id, map_old_to_new[neighbor_id]);
+    contracted.m_data_graph.reset(new graph_access());
+    graph_access &G = *contracted.m_data_graph;
+    G.start_construction(number_of_clusters, number_of_contracted_edges);
+    for (NodeID c = 0; c < number_of_clusters; ++c) {
+        NodeID node_id = G.new_node();
+        G.setPartitionIndex(node_id, 0);
+        G.setNodeWeight(node_id, static_cast<NodeWeight>(first_member[c + 1] - first_member[c]));
+
+        for (auto &edge : edges[c]) {
+            EdgeID edge_id = G.new_edge(node_id, edge.first);
+            G.setEdgeWeight(edge_id, edge.second);
         }
+        std::vector<std::pair<NodeID, EdgeWeight>>().swap(edges[c]);
     }
+    G.finish_construction();
 
-    for (int i = 0; i < 2; ++i) {
-        subgraphs[i].finish_construction();
-        subgraphs[i].data_graph().finish_construction();
+    contracted.m_branch_id = m_branch_id;
+    contracted.construct_query_edges();
+    if (m_is_compressed) {
+        contracted.compress();
+    }
+}
 
-        // TODO q&d solution to get adjacent query nodes of a data node
-        subgraphs[i].m_parent = this;
-        subgraphs[i].m_map_to_parent = map_new_to_old[i];
+/**
+ * Replaces the CSR arrays of both directions by gap encoded adjacency lists and releases the arrays. The query edges
+ * of every query node are sorted in the process.
+ */
+void query_graph::compress() {
+    assert(!m_is_constructing);
+    if (m_is_compressed) {
+        return;
     }
 
-    // Validate result with some basic sanity checks
-    assert(number_of_query_nodes() == subgraphs[0].number_of_query_nodes());
-    assert(number_of_query_nodes() == subgraphs[1].number_of_query_nodes());
-    assert(number_of_query_edges() == subgraphs[0].number_of_query_edges() + subgraphs[1].number_of_query_edges());
-    assert(m_data_graph.number_of_nodes()
-           == subgraphs[0].data_graph().number_of_nodes() + subgraphs[1].data_graph().number_of_nodes());
-    assert(m_data_graph.number_of_edges()
-           >= subgraphs[0].data_graph().number_of_edges() + subgraphs[1].data_graph().number_of_edges());
+    m_compressed_query_edges.encode(m_query_nodes, m_query_edges);
+    if (!m_is_symmetric) {
+        m_compressed_data_edges.encode(m_data_nodes, m_data_edges);
+    }
 
-    return map_new_to_old;
+    if (m_storage != nullptr) {
+        release_storage();
+    } else {
+        numa_vector<EdgeID>().swap(m_query_nodes);
+        numa_vector<NodeID>().swap(m_query_edges);
+        numa_vector<EdgeID>().swap(m_data_nodes);
+        numa_vector<NodeID>().swap(m_data_edges);
+    }
+
+    m_is_compressed = true;
+}
+
+/**
+ * Borrows the CSR arrays, keeping their capacity but not their content.
+ *
+ * @param arrays
+ */
+void query_graph::acquire_storage(csr_arrays &arrays) {
+    assert(m_storage == nullptr);
+    assert(m_query_nodes.empty() && m_query_edges.empty());
+
+    m_storage = &arrays;
+    m_query_nodes.swap(arrays.query_nodes);
+    m_query_edges.swap(arrays.query_edges);
+    m_data_nodes.swap(arrays.data_nodes);
+    m_data_edges.swap(arrays.data_edges);
+
+    m_query_nodes.clear();
+    m_query_edges.clear();
+    m_data_nodes.clear();
+    m_data_edges.clear();
+}
+
+/**
+ * Gives borrowed CSR arrays back to their storage, where they are reused by the next subgraph of the same slot.
+ * Afterwards, only the data nodes and the partition of an uncompressed graph may be used. Does nothing if the arrays
+ * are owned by this graph.
+ */
+void query_graph::release_storage() {
+    if (m_storage == nullptr) {
+        return;
+    }
+
+    m_query_nodes.swap(m_storage->query_nodes);
+    m_query_edges.swap(m_storage->query_edges);
+    m_data_nodes.swap(m_storage->data_nodes);
+    m_data_edges.swap(m_storage->data_edges);
+    m_storage = nullptr;
+}
+
+/**
+ * @return bytes used by the adjacency of both directions and the partition, not counting the data graph
+ */
+std::size_t query_graph::memory_size() {
+    std::size_t size = m_partition.size() + m_map_to_parent.size() * sizeof(NodeID);
+    if (m_is_compressed) {
+        return size + m_compressed_query_edges.memory_size() + m_compressed_data_edges.memory_size();
+    }
+    return size + (m_query_nodes.size() + m_data_nodes.size()) * sizeof(EdgeID)
+           + (m_query_edges.size() + m_data_edges.size()) * sizeof(NodeID);
+}
+
+/**
+ * Builds the data graph from the adjacency of this graph: the data neighbors of a data node are the neighbors of the
+ * query node of its root data node, see {@code construct_query_edges()}. Hence, neither the data graph of the root
+ * nor the ones of other ancestors are needed. All node and edge weights are 1.
+ */
+void query_graph::materialize_data_graph() {
+    // Step 1: Count the data edges between the data nodes of this graph
+    EdgeID number_of_data_edges = 0;
+    for (NodeID node_id = 0; node_id < number_of_data_nodes(); ++node_id) {
+        number_of_data_edges += get_adjacent_data_nodes(get_root_data_node(node_id)).size();
+    }
+
+    // Step 2: Construct the data graph
+    m_data_graph.reset(new graph_access());
+    graph_access &G = *m_data_graph;
+    G.start_construction(number_of_data_nodes(), number_of_data_edges);
+    for (NodeID node_id = 0; node_id < number_of_data_nodes(); ++node_id) {
+        NodeID new_node_id = G.new_node();
+        G.setPartitionIndex(new_node_id, 0);
+        G.setNodeWeight(new_node_id, 1);
+
+        for (NodeID neighbor_id : get_adjacent_data_nodes(get_root_data_node(node_id))) {
+            EdgeID new_edge_id = G.new_edge(new_node_id, neighbor_id);
+            G.setEdgeWeight(new_edge_id, 1);
+        }
+    }
+    G.finish_construction();
 }
 
 /**
@@ -166,9 +422,9 @@ query_graph::build_partition_induced_subgraphs(std::array<query_graph, 2> &subgr
  */
 std::array<NodeID, 2> query_graph::count_partition_sizes() {
     std::array<NodeID, 2> sizes = {0, 0};
-    forall_nodes(m_data_graph, node_id)
-            ++sizes[m_data_graph.getPartitionIndex(node_id)];
-    endfor
+    for (std::uint8_t partition : m_partition) {
+        ++sizes[partition];
+    }
     return sizes;
 }
 
@@ -179,59 +435,101 @@ std::array<NodeID, 2> query_graph::count_partition_sizes() {
  */
 std::array<NodeID, 2> query_graph::count_query_node_degrees(NodeID node_id) {
     std::array<NodeID, 2> degrees = {0, 0};
-    for (EdgeID edge_id = get_first_edge(node_id); edge_id < get_first_invalid_edge(node_id); ++edge_id) {
-        NodeID neighbor_id = get_edge_target(edge_id);
-        ++degrees[m_data_graph.getPartitionIndex(neighbor_id)];
+    for (NodeID neighbor_id : get_adjacent_data_nodes(node_id)) {
+        ++degrees[get_partition(neighbor_id)];
     }
     return degrees;
 }
 
-NodeID query_graph::number_of_query_nodes() {
-    return static_cast<NodeID>(m_query_nodes.size()) - 1;
-}
-
-EdgeID query_graph::number_of_query_edges() {
-    return static_cast<EdgeID>(m_query_edges.size());
-}
-
+/**
+ * The data graph, materialized on first use and after {@code release_data_graph()}. Its partition indices are not
+ * maintained.
+ *
+ * @return
+ */
 graph_access &query_graph::data_graph() {
-    return m_data_graph;
+    if (!m_data_graph) {
+        materialize_data_graph();
+    }
+    return *m_data_graph;
 }
 
-EdgeID query_graph::get_first_edge(NodeID node_id) {
-    assert(node_id < number_of_query_nodes());
-
-    return m_query_nodes[node_id];
+/**
+ * Frees the data graph, e.g. once the query edges of the root graph are constructed or once the bisection of a
+ * subgraph is done; {@code data_graph()} materializes it again if needed.
+ */
+void query_graph::release_data_graph() {
+    m_data_graph.reset();
 }
 
-EdgeID query_graph::get_first_invalid_edge(NodeID node_id) {
-    assert(node_id < number_of_query_nodes());
-
-    return m_query_nodes[node_id + 1];
+/**
+ * The data graph with the current partition, e.g. for quality metrics and for writing the partition to a file.
+ *
+ * @return
+ */
+graph_access &query_graph::synchronized_data_graph() {
+    graph_access &G = data_graph();
+    G.set_partition_count(2);
+    forall_nodes(G, node_id)
+            G.setPartitionIndex(node_id, get_partition(node_id));
+    endfor
+    return G;
 }
 
-std::vector<NodeID> query_graph::get_adjacent_query_nodes(NodeID data_node_id) {
-    if (m_parent != this) {
-        return m_parent->get_adjacent_query_nodes(m_map_to_parent[data_node_id]);
+/**
+ * A data node is a boundary node if it has a data neighbor in the other partition. The data neighbors of a data node
+ * are the neighbors of its query node, see {@code construct_query_edges()}.
+ *
+ * @param data_node_id
+ * @return
+ */
+bool query_graph::is_boundary_node(NodeID data_node_id) {
+    for (NodeID neighbor_id : get_adjacent_data_nodes(get_root_data_node(data_node_id))) {
+        if (get_partition(neighbor_id) != get_partition(data_node_id)) {
+            return true;
+        }
     }
-
-    std::vector<NodeID> adjacent_query_nodes;
-    forall_out_edges(data_graph(), edge, data_node_id)
-            adjacent_query_nodes.push_back(data_graph().getEdgeTarget(edge));
-    endfor
-    return adjacent_query_nodes;
+    return false;
 }
 
-std::size_t query_graph::get_number_of_adjacent_query_nodes(NodeID data_node_id) {
+/**
+ * Maps a data node of this graph to the corresponding data node of the graph at the root of the recursion.
+ *
+ * @param data_node_id
+ * @return
+ */
+NodeID query_graph::get_root_data_node(NodeID data_node_id) {
     if (m_parent != this) {
-        return m_parent->get_number_of_adjacent_query_nodes(m_map_to_parent[data_node_id]);
+        return m_parent->get_root_data_node(m_map_to_parent[data_node_id]);
     }
 
-    return data_graph().get_first_invalid_edge(data_node_id) - data_graph().get_first_edge(data_node_id);
+    return data_node_id;
 }
 
-NodeID query_graph::get_edge_target(EdgeID edge_id) {
-    assert(edge_id < number_of_query_edges());
+/**
+ * @return the graph at the root of the recursion
+ */
+query_graph &query_graph::root() {
+    return m_parent != this ? m_parent->root() : *this;
+}
 
-    return m_query_edges[edge_id];
+/**
+ * Identifies the subgraph by its position in the recursion tree, independent of the order in which subgraphs are
+ * processed.
+ *
+ * @return
+ */
+std::uint64_t query_graph::branch_id() {
+    return m_branch_id;
+}
+
+/**
+ * Identifies the graph that {@code construct_query_edges()} was last called on. Unlike the address of the graph, the
+ * id is never reused, hence it tells whether state kept by a partitioner belongs to the root graph at hand. Subgraphs
+ * are identified by the id of {@code root()} and their branch id.
+ *
+ * @return
+ */
+std::uint64_t query_graph::graph_id() {
+    return m_graph_id;
 }
@@ -3,31 +3,70 @@
 
 #include <data_structure/graph_access.h>
 #include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "compressed_adjacency.h"
+#include "numa_allocator.h"
+#include "subgraph_storage.h"
 
 namespace bathesis {
 
     /**
-     * Wrapper around {@code graph_access} that manages query nodes.
+     * Bipartite graph of query nodes and data nodes, stored as compact CSR in both directions, plus the partition of
+     * the data nodes.
      *
      * To use this class, first load the data graph using {@code graph_io::readGraphWeighted(G.data_graph(), "...")},
-     * then either add query nodes manually using {@code start_construction()}, {@code add_query_edge()} and
-     * {@code finish_construction()} or use {@code extract_query_edges()} to automatically construct a query node for
-     * every data node.
+     * then use {@code construct_query_edges()} to construct a query node for every data node: the neighbors of query
+     * node v are the data neighbors of data node v. In the root graph, both directions are the same, hence only the
+     * query side is stored. Subgraphs keep all query nodes, hence the data neighbors of a data node of a subgraph are
+     * the neighbors of the query node of its root data node.
+     *
+     * The {@code graph_access} of the root graph is only needed to construct the query edges; afterwards it can be
+     * freed using {@code release_data_graph()}. {@code data_graph()} materializes the data graph from the adjacency of
+     * this graph when it is needed, e.g. by KaHIP, with unit node and edge weights; all other code works on the CSR
+     * arrays and the partition array of this class. Partition indices of the {@code graph_access} are not kept up to
+     * date, use {@code synchronized_data_graph()} to copy the partition into it.
      *
-     * This class only offers access to query nodes; use {@code data_graph()} to gain access to the underlying data
-     * graph.
+     * {@code compress()} replaces both CSR directions by {@code compressed_adjacency}; subgraphs of a compressed graph
+     * are compressed as well. {@code construct_query_edges(true)} encodes the root graph directly from the data graph.
+     * Compressed graphs only provide the node ranges and degrees, not edge ids.
+     *
+     * The CSR arrays of subgraphs built by {@code build_partition_induced_subgraphs()} are lent by a
+     * {@code subgraph_storage} and must be given back using {@code release_storage()} once the subgraph is no longer
+     * needed.
      */
     class query_graph {
-        query_graph *m_parent; // q&d solution to get the query neighbors of a data node
-        graph_access m_data_graph;
-        std::vector<EdgeID> m_query_nodes; // m_query_nodes[node id] = first edge id
-        std::vector<NodeID> m_query_edges; // m_query_edges[edge id] = target node id
+        query_graph *m_parent;
+        std::unique_ptr<graph_access> m_data_graph; // nullptr until materialized
+        numa_vector<EdgeID> m_query_nodes; // m_query_nodes[node id] = first edge id
+        numa_vector<NodeID> m_query_edges; // m_query_edges[edge id] = target node id
+        numa_vector<EdgeID> m_data_nodes;  // m_data_nodes[node id] = first edge id
+        numa_vector<NodeID> m_data_edges;  // m_data_edges[edge id] = adjacent query node id, ascending per data node
+        compressed_adjacency m_compressed_query_edges;
+        compressed_adjacency m_compressed_data_edges;
+        bool m_is_compressed;
+        bool m_is_symmetric; // the data side is the query side, m_data_nodes and m_data_edges are not used
+        csr_arrays *m_storage; // lender of the CSR arrays, nullptr if they are owned
+        numa_vector<std::uint8_t> m_partition;
         std::vector<NodeID> m_map_to_parent;
+        std::uint64_t m_branch_id; // position in the recursion tree: the root is 1, the subgraphs of b are 2b and 2b + 1
+        std::uint64_t m_graph_id;  // see graph_id()
 
         // construction
         bool m_is_constructing;
         NodeID m_last_source_id;
 
+        void initialize_partition();
+
+        void build_data_edges();
+
+        void materialize_data_graph();
+
+        void acquire_storage(csr_arrays &arrays);
+
     public:
         query_graph();
 
@@ -37,31 +76,143 @@ namespace bathesis {
 
         void add_query_edge(NodeID source_id, NodeID target_id);
 
-        void construct_query_edges();
+        void construct_query_edges(bool compressed = false);
 
         void finish_construction();
 
-        std::array<std::vector<NodeID>, 2> build_partition_induced_subgraphs(std::array<query_graph, 2> &subgraphs);
-
-        std::array<NodeID, 2> count_partition_sizes();
+        void compress();
 
-        std::array<NodeID, 2> count_query_node_degrees(NodeID node_id);
+        bool is_compressed() {
+            return m_is_compressed;
+        }
 
-        NodeID number_of_query_nodes();
+        std::size_t memory_size();
 
-        EdgeID number_of_query_edges();
+        std::array<std::vector<NodeID>, 2> build_partition_induced_subgraphs(std::array<query_graph, 2> &subgraphs,
+                                                                             subgraph_storage &storage);
 
-        EdgeID get_first_edge(NodeID node_id);
+        void release_storage();
 
-        EdgeID get_first_invalid_edge(NodeID node_id);
+        void build_contracted_graph(const std::vector<NodeID> &cluster, NodeID number_of_clusters,
+                                    query_graph &contracted);
 
-        NodeID get_edge_target(EdgeID edge_id);
+        std::array<NodeID, 2> count_partition_sizes();
 
-        std::vector<NodeID> get_adjacent_query_nodes(NodeID data_node_id);
+        std::array<NodeID, 2> count_query_node_degrees(NodeID node_id);
 
-        std::size_t get_number_of_adjacent_query_nodes(NodeID data_node_id);
+        NodeID number_of_query_nodes() {
+            if (m_is_compressed) {
+                return m_compressed_query_edges.number_of_nodes();
+            }
+            return static_cast<NodeID>(m_query_nodes.size()) - 1;
+        }
+
+        EdgeID number_of_query_edges() {
+            if (m_is_compressed) {
+                return m_compressed_query_edges.number_of_edges();
+            }
+            return static_cast<EdgeID>(m_query_edges.size());
+        }
+
+        NodeID number_of_data_nodes() {
+            return static_cast<NodeID>(m_partition.size());
+        }
+
+        EdgeID get_first_edge(NodeID node_id) {
+            assert(!m_is_compressed);
+            assert(node_id < number_of_query_nodes());
+            return m_query_nodes[node_id];
+        }
+
+        EdgeID get_first_invalid_edge(NodeID node_id) {
+            assert(!m_is_compressed);
+            assert(node_id < number_of_query_nodes());
+            return m_query_nodes[node_id + 1];
+        }
+
+        NodeID get_edge_target(EdgeID edge_id) {
+            assert(!m_is_compressed);
+            assert(edge_id < number_of_query_edges());
+            return m_query_edges[edge_id];
+        }
+
+        EdgeID get_first_data_edge(NodeID data_node_id) {
+            assert(!m_is_compressed);
+            assert(data_node_id < number_of_data_nodes());
+            return m_is_symmetric ? m_query_nodes[data_node_id] : m_data_nodes[data_node_id];
+        }
+
+        EdgeID get_first_invalid_data_edge(NodeID data_node_id) {
+            assert(!m_is_compressed);
+            assert(data_node_id < number_of_data_nodes());
+            return m_is_symmetric ? m_query_nodes[data_node_id + 1] : m_data_nodes[data_node_id + 1];
+        }
+
+        NodeID get_data_edge_target(EdgeID edge_id) {
+            assert(!m_is_compressed);
+            assert(edge_id < number_of_query_edges());
+            return m_is_symmetric ? m_query_edges[edge_id] : m_data_edges[edge_id];
+        }
+
+        /**
+         * @param node_id query node
+         * @return the data nodes adjacent to the query node, in the order in which their edges were added or, if the
+         * graph is compressed or a root graph, in ascending order
+         */
+        node_range get_adjacent_data_nodes(NodeID node_id) {
+            if (m_is_compressed) {
+                return m_compressed_query_edges.neighbors(node_id);
+            }
+            return {m_query_edges.data() + get_first_edge(node_id),
+                    m_query_edges.data() + get_first_invalid_edge(node_id)};
+        }
+
+        /**
+         * @param data_node_id
+         * @return the query nodes adjacent to the data node in ascending order
+         */
+        node_range get_adjacent_query_nodes(NodeID data_node_id) {
+            if (m_is_symmetric) {
+                return get_adjacent_data_nodes(data_node_id);
+            }
+            if (m_is_compressed) {
+                return m_compressed_data_edges.neighbors(data_node_id);
+            }
+            return {m_data_edges.data() + get_first_data_edge(data_node_id),
+                    m_data_edges.data() + get_first_invalid_data_edge(data_node_id)};
+        }
+
+        std::size_t get_number_of_adjacent_query_nodes(NodeID data_node_id) {
+            if (m_is_compressed) {
+                return (m_is_symmetric ? m_compressed_query_edges : m_compressed_data_edges).degree(data_node_id);
+            }
+            return get_first_invalid_data_edge(data_node_id) - get_first_data_edge(data_node_id);
+        }
+
+        PartitionID get_partition(NodeID data_node_id) {
+            return m_partition[data_node_id];
+        }
+
+        void set_partition(NodeID data_node_id, PartitionID partition) {
+            assert(partition < 2);
+            m_partition[data_node_id] = static_cast<std::uint8_t>(partition);
+        }
+
+        bool is_boundary_node(NodeID data_node_id);
+
+        NodeID get_root_data_node(NodeID data_node_id);
+
+        query_graph &root();
 
         graph_access &data_graph();
+
+        void release_data_graph();
+
+        graph_access &synchronized_data_graph();
+
+        std::uint64_t branch_id();
+
+        std::uint64_t graph_id();
     };
 }
 
@@ -0,0 +1,27 @@
+#include "subgraph_storage.h"
+
+#include <cassert>
+
+using namespace bathesis;
+
+/**
+ * The slot of the subgraph with the given branch id, i.e. of its recursion level and its side of the bisection.
+ *
+ * @param branch_id branch id of a subgraph, see {@code query_graph::branch_id()}
+ * @return
+ */
+csr_arrays &subgraph_storage::slot(std::uint64_t branch_id) {
+    assert(branch_id > 1); // the root graph is not a subgraph
+
+    std::size_t level = 0;
+    for (std::uint64_t id = branch_id; id > 1; id >>= 1) {
+        ++level;
+    }
+    std::size_t index = 2 * (level - 1) + (branch_id & 1);
+
+    while (m_slots.size() <= index) {
+        m_slots.emplace_back();
+    }
+    return m_slots[index];
+}
+
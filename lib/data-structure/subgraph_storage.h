@@ -0,0 +1,47 @@
+#ifndef IMPL_SUBGRAPH_STORAGE_H
+#define IMPL_SUBGRAPH_STORAGE_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <data_structure/graph_access.h>
+
+#include "numa_allocator.h"
+
+namespace bathesis {
+
+    /**
+     * CSR arrays of a {@code query_graph}, see there.
+     */
+    struct csr_arrays {
+        numa_vector<EdgeID> query_nodes;
+        numa_vector<NodeID> query_edges;
+        numa_vector<EdgeID> data_nodes;
+        numa_vector<NodeID> data_edges;
+    };
+
+    /**
+     * Storage for the CSR arrays of the subgraphs of the recursion, reused across subproblems instead of allocating
+     * and freeing them for every subgraph.
+     *
+     * The recursion is depth first, hence at any time at most one subgraph per recursion level and side of the
+     * bisection is alive. Each such pair has a slot whose arrays are lent to the subgraph while it is alive and keep
+     * their capacity after it is released, so the subgraphs of the sibling subtree are built without allocating once
+     * the slot has grown to their size. The uncompressed arrays of compressed subgraphs are only needed while the
+     * subgraph is built and share a single scratch slot.
+     */
+    class subgraph_storage {
+        std::deque<csr_arrays> m_slots; // references stay valid when slots are added
+        csr_arrays m_scratch;
+
+    public:
+        csr_arrays &slot(std::uint64_t branch_id);
+
+        csr_arrays &scratch() {
+            return m_scratch;
+        }
+    };
+}
+
+#endif // IMPL_SUBGRAPH_STORAGE_H
@@ -0,0 +1,260 @@
+#include "weighted_query_graph.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace bathesis;
+
+namespace {
+    using weighted_edge = std::pair<NodeID, NodeID>; // (target, weight)
+
+    /**
+     * Sorts the edges by target and merges parallel edges by adding their weights.
+     *
+     * @param edges
+     */
+    void merge_parallel_edges(std::vector<weighted_edge> &edges) {
+        std::sort(edges.begin(), edges.end());
+
+        std::size_t last = 0;
+        for (std::size_t i = 1; i < edges.size(); ++i) {
+            if (edges[i].first == edges[last].first) {
+                edges[last].second += edges[i].second;
+            } else {
+                edges[++last] = edges[i];
+            }
+        }
+        if (!edges.empty()) {
+            edges.resize(last + 1);
+        }
+    }
+
+    template<typename Offsets>
+    void prefix_sum(Offsets &offsets) {
+        for (std::size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+    }
+}
+
+/**
+ * Builds the uncontracted weighted graph of {@code QG}, including its current partition.
+ *
+ * @param QG
+ */
+weighted_query_graph::weighted_query_graph(query_graph &QG) {
+    const NodeID num_data_nodes = QG.number_of_data_nodes();
+    const NodeID num_query_nodes = QG.number_of_query_nodes();
+
+    m_node_weights.assign(num_data_nodes, 1);
+    m_partition.resize(num_data_nodes);
+    m_data_nodes.assign(num_data_nodes + 1, 0);
+    m_query_nodes.assign(num_query_nodes + 1, 0);
+
+    // only the node ranges of QG are used, hence QG may be compressed
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID v = 0; v < num_data_nodes; ++v) {
+        m_partition[v] = QG.get_partition(v);
+        m_data_nodes[v + 1] = static_cast<EdgeID>(QG.get_number_of_adjacent_query_nodes(v));
+    }
+    prefix_sum(m_data_nodes);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        m_query_nodes[q + 1] = static_cast<EdgeID>(QG.get_adjacent_data_nodes(q).size());
+    }
+    prefix_sum(m_query_nodes);
+
+    m_data_edges.resize(QG.number_of_query_edges());
+    m_data_edge_weights.assign(QG.number_of_query_edges(), 1);
+    m_query_edges.resize(QG.number_of_query_edges());
+    m_query_edge_weights.assign(QG.number_of_query_edges(), 1);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID v = 0; v < num_data_nodes; ++v) {
+        auto adjacent_query_nodes = QG.get_adjacent_query_nodes(v);
+        std::copy(adjacent_query_nodes.begin(), adjacent_query_nodes.end(), m_data_edges.begin() + m_data_nodes[v]);
+    }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        auto adjacent_data_nodes = QG.get_adjacent_data_nodes(q);
+        std::copy(adjacent_data_nodes.begin(), adjacent_data_nodes.end(), m_query_edges.begin() + m_query_nodes[q]);
+    }
+
+    assert(m_data_edges.size() == m_query_edges.size());
+}
+
+/**
+ * Contracts the data nodes of this graph.
+ *
+ * All data nodes that are mapped to the same coarse node must belong to the same partition.
+ *
+ * @param map map[data node] = coarse data node
+ * @param number_of_coarse_nodes
+ * @return the contracted graph with the partition of this graph
+ */
+weighted_query_graph
+weighted_query_graph::contract(const std::vector<NodeID> &map, NodeID number_of_coarse_nodes) const {
+    assert(map.size() == number_of_data_nodes());
+
+    weighted_query_graph coarse;
+    const NodeID num_query_nodes = number_of_query_nodes();
+
+    // members of each coarse node
+    std::vector<EdgeID> first_member(number_of_coarse_nodes + 1, 0);
+    for (NodeID v = 0; v < number_of_data_nodes(); ++v) {
+        ++first_member[map[v] + 1];
+    }
+    prefix_sum(first_member);
+
+    std::vector<NodeID> members(number_of_data_nodes());
+    {
+        std::vector<EdgeID> next_member(first_member.begin(), first_member.end() - 1);
+        for (NodeID v = 0; v < number_of_data_nodes(); ++v) {
+            members[next_member[map[v]]++] = v;
+        }
+    }
+
+    // collects the merged edges of a coarse data node
+    auto collect_data_edges = [&](NodeID c, std::vector<weighted_edge> &edges) {
+        edges.clear();
+        for (EdgeID i = first_member[c]; i < first_member[c + 1]; ++i) {
+            NodeID v = members[i];
+            for (EdgeID e = get_first_data_edge(v); e < get_first_invalid_data_edge(v); ++e) {
+                edges.emplace_back(get_data_edge_target(e), get_data_edge_weight(e));
+            }
+        }
+        merge_parallel_edges(edges);
+    };
+
+    // collects the merged edges of a query node
+    auto collect_query_edges = [&](NodeID q, std::vector<weighted_edge> &edges) {
+        edges.clear();
+        for (EdgeID e = get_first_query_edge(q); e < get_first_invalid_query_edge(q); ++e) {
+            edges.emplace_back(map[get_query_edge_target(e)], get_query_edge_weight(e));
+        }
+        merge_parallel_edges(edges);
+    };
+
+    // Step 1: Count the edges of every coarse node
+    coarse.m_node_weights.assign(number_of_coarse_nodes, 0);
+    coarse.m_partition.resize(number_of_coarse_nodes);
+    coarse.m_data_nodes.assign(number_of_coarse_nodes + 1, 0);
+    coarse.m_query_nodes.assign(num_query_nodes + 1, 0);
+
+#pragma omp parallel
+    {
+        std::vector<weighted_edge> edges;
+
+#pragma omp for schedule(dynamic, 1024) nowait
+        for (NodeID c = 0; c < number_of_coarse_nodes; ++c) {
+            assert(first_member[c] < first_member[c + 1]);
+            coarse.m_partition[c] = m_partition[members[first_member[c]]];
+            for (EdgeID i = first_member[c]; i < first_member[c + 1]; ++i) {
+                assert(m_partition[members[i]] == coarse.m_partition[c]);
+                coarse.m_node_weights[c] += m_node_weights[members[i]];
+            }
+
+            collect_data_edges(c, edges);
+            coarse.m_data_nodes[c + 1] = static_cast<EdgeID>(edges.size());
+        }
+
+#pragma omp for schedule(dynamic, 1024)
+        for (NodeID q = 0; q < num_query_nodes; ++q) {
+            collect_query_edges(q, edges);
+            coarse.m_query_nodes[q + 1] = static_cast<EdgeID>(edges.size());
+        }
+    }
+    prefix_sum(coarse.m_data_nodes);
+    prefix_sum(coarse.m_query_nodes);
+
+    // Step 2: Fill the edge arrays
+    coarse.m_data_edges.resize(coarse.m_data_nodes[number_of_coarse_nodes]);
+    coarse.m_data_edge_weights.resize(coarse.m_data_nodes[number_of_coarse_nodes]);
+    coarse.m_query_edges.resize(coarse.m_query_nodes[num_query_nodes]);
+    coarse.m_query_edge_weights.resize(coarse.m_query_nodes[num_query_nodes]);
+
+#pragma omp parallel
+    {
+        std::vector<weighted_edge> edges;
+
+#pragma omp for schedule(dynamic, 1024) nowait
+        for (NodeID c = 0; c < number_of_coarse_nodes; ++c) {
+            collect_data_edges(c, edges);
+            EdgeID e = coarse.m_data_nodes[c];
+            for (auto &edge : edges) {
+                coarse.m_data_edges[e] = edge.first;
+                coarse.m_data_edge_weights[e] = edge.second;
+                ++e;
+            }
+        }
+
+#pragma omp for schedule(dynamic, 1024)
+        for (NodeID q = 0; q < num_query_nodes; ++q) {
+            collect_query_edges(q, edges);
+            EdgeID e = coarse.m_query_nodes[q];
+            for (auto &edge : edges) {
+                coarse.m_query_edges[e] = edge.first;
+                coarse.m_query_edge_weights[e] = edge.second;
+                ++e;
+            }
+        }
+    }
+
+    assert(coarse.m_data_edges.size() == coarse.m_query_edges.size());
+    return coarse;
+}
+
+/**
+ * Assigns every data node of {@code finer} to the partition of its coarse node.
+ *
+ * @param finer the graph this graph was contracted from
+ * @param map the map that was used to contract {@code finer}
+ */
+void weighted_query_graph::project_partition(weighted_query_graph &finer, const std::vector<NodeID> &map) const {
+    assert(map.size() == finer.number_of_data_nodes());
+
+#pragma omp parallel for schedule(static)
+    for (NodeID v = 0; v < finer.number_of_data_nodes(); ++v) {
+        finer.m_partition[v] = m_partition[map[v]];
+    }
+}
+
+std::array<NodeID, 2> weighted_query_graph::calculate_partition_weights() const {
+    std::array<NodeID, 2> weights = {0, 0};
+    for (NodeID v = 0; v < number_of_data_nodes(); ++v) {
+        weights[m_partition[v]] += m_node_weights[v];
+    }
+    return weights;
+}
+
+/**
+ * Calculates the same partition cost as {@code utils::calculate_partition_cost()} on the original graph: the degree
+ * of a query node in a partition is the summed weight of its edges into the partition, and the size of a partition
+ * is its summed node weight.
+ *
+ * @tparam CostModel
+ * @return
+ */
+template<typename CostModel>
+double weighted_query_graph::calculate_partition_cost() const {
+    const auto weights = calculate_partition_weights();
+
+    double cost = 0.0;
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: cost)
+    for (NodeID q = 0; q < number_of_query_nodes(); ++q) {
+        std::array<NodeID, 2> degrees = {0, 0};
+        for (EdgeID e = get_first_query_edge(q); e < get_first_invalid_query_edge(q); ++e) {
+            degrees[m_partition[get_query_edge_target(e)]] += get_query_edge_weight(e);
+        }
+        cost += calculate_query_node_cost<CostModel>(weights, degrees);
+    }
+
+    return cost;
+}
+
+template double weighted_query_graph::calculate_partition_cost<loggap_cost>() const;
+template double weighted_query_graph::calculate_partition_cost<log_cost>() const;
+template double weighted_query_graph::calculate_partition_cost<mla_cost>() const;
+template double weighted_query_graph::calculate_partition_cost<k2tree_cost>() const;
@@ -0,0 +1,101 @@
+#ifndef IMPL_WEIGHTED_QUERY_GRAPH_H
+#define IMPL_WEIGHTED_QUERY_GRAPH_H
+
+#include <array>
+#include <vector>
+
+#include "query_graph.h"
+#include "../refinement/cost_models.h"
+
+namespace bathesis {
+
+    /**
+     * Compact bipartite graph with weighted data nodes and weighted edges between query and data nodes, used by the
+     * multilevel algorithms.
+     *
+     * A data node represents a set of data nodes of the original {@code query_graph}; its weight is the size of that
+     * set. An edge between a query node and a data node has the number of original edges between the query node and
+     * the set as weight. Query nodes are never contracted, hence the partition cost of a contracted graph equals the
+     * partition cost of the original graph under the projected partition.
+     *
+     * Both directions are stored as CSR arrays; the query nodes adjacent to a data node are sorted by id.
+     */
+    class weighted_query_graph {
+        numa_vector<NodeID> m_node_weights;       // m_node_weights[data node] = number of original data nodes
+        numa_vector<EdgeID> m_data_nodes;         // m_data_nodes[data node] = first data edge id
+        numa_vector<NodeID> m_data_edges;         // m_data_edges[data edge] = target query node
+        numa_vector<NodeID> m_data_edge_weights;
+        numa_vector<EdgeID> m_query_nodes;        // m_query_nodes[query node] = first query edge id
+        numa_vector<NodeID> m_query_edges;        // m_query_edges[query edge] = target data node
+        numa_vector<NodeID> m_query_edge_weights;
+        numa_vector<PartitionID> m_partition;
+
+    public:
+        weighted_query_graph() = default;
+
+        explicit weighted_query_graph(query_graph &QG);
+
+        weighted_query_graph contract(const std::vector<NodeID> &map, NodeID number_of_coarse_nodes) const;
+
+        void project_partition(weighted_query_graph &finer, const std::vector<NodeID> &map) const;
+
+        std::array<NodeID, 2> calculate_partition_weights() const;
+
+        template<typename CostModel = loggap_cost>
+        double calculate_partition_cost() const;
+
+        NodeID number_of_data_nodes() const {
+            return static_cast<NodeID>(m_node_weights.size());
+        }
+
+        NodeID number_of_query_nodes() const {
+            return static_cast<NodeID>(m_query_nodes.size()) - 1;
+        }
+
+        NodeID get_node_weight(NodeID node) const {
+            return m_node_weights[node];
+        }
+
+        EdgeID get_first_data_edge(NodeID data_node) const {
+            return m_data_nodes[data_node];
+        }
+
+        EdgeID get_first_invalid_data_edge(NodeID data_node) const {
+            return m_data_nodes[data_node + 1];
+        }
+
+        NodeID get_data_edge_target(EdgeID edge) const {
+            return m_data_edges[edge];
+        }
+
+        NodeID get_data_edge_weight(EdgeID edge) const {
+            return m_data_edge_weights[edge];
+        }
+
+        EdgeID get_first_query_edge(NodeID query_node) const {
+            return m_query_nodes[query_node];
+        }
+
+        EdgeID get_first_invalid_query_edge(NodeID query_node) const {
+            return m_query_nodes[query_node + 1];
+        }
+
+        NodeID get_query_edge_target(EdgeID edge) const {
+            return m_query_edges[edge];
+        }
+
+        NodeID get_query_edge_weight(EdgeID edge) const {
+            return m_query_edge_weights[edge];
+        }
+
+        PartitionID get_partition(NodeID data_node) const {
+            return m_partition[data_node];
+        }
+
+        void set_partition(NodeID data_node, PartitionID partition) {
+            m_partition[data_node] = partition;
+        }
+    };
+}
+
+#endif // IMPL_WEIGHTED_QUERY_GRAPH_H
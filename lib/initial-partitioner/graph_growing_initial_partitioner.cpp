@@ -0,0 +1,141 @@
+#include "graph_growing_initial_partitioner.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "../data-structure/addressable_heap.h"
+#include "../utils.h"
+
+using namespace bathesis;
+
+graph_growing_initial_partitioner::graph_growing_initial_partitioner(uint seed, int attempts)
+        : m_seed(seed), m_attempts(attempts) {
+    assert (m_attempts > 0);
+}
+
+void graph_growing_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_level,
+                                                             reporter &reporter) {
+    reporter.initial_partitioning_start(QG);
+
+    auto &G = QG.data_graph(); // grows along the data edges
+
+    std::vector<std::vector<PartitionID>> partitions(m_attempts);
+    std::vector<double> costs(m_attempts);
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < m_attempts; ++i) {
+        partitions[i] = grow_bisection(G, utils::derive_seed(m_seed, QG.branch_id(), static_cast<uint>(i)));
+        costs[i] = utils::calculate_partition_cost(QG, partitions[i]);
+    }
+
+    auto best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+    utils::set_partition(QG, partitions[best]);
+
+    reporter.initial_partitioning_finish(QG);
+}
+
+/**
+ * Repeats breadth-first searches, each starting at the node found last by the previous one, as long as the depth of
+ * the search increases.
+ *
+ * @param G
+ * @param start
+ * @return a node with high eccentricity in the connected component of {@code start}
+ */
+NodeID graph_growing_initial_partitioner::find_pseudo_peripheral_node(graph_access &G, NodeID start) {
+    const NodeID unreached = std::numeric_limits<NodeID>::max();
+    std::vector<NodeID> depth(G.number_of_nodes());
+    std::vector<NodeID> queue;
+
+    NodeID max_depth = 0;
+    for (int sweep = 0; sweep < 5; ++sweep) {
+        std::fill(depth.begin(), depth.end(), unreached);
+        queue.clear();
+        queue.push_back(start);
+        depth[start] = 0;
+
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            NodeID u = queue[head];
+            forall_out_edges(G, e, u) {
+                        NodeID v = G.getEdgeTarget(e);
+                        if (depth[v] == unreached) {
+                            depth[v] = depth[u] + 1;
+                            queue.push_back(v);
+                        }
+                    }endfor
+        }
+
+        NodeID last = queue.back();
+        if (sweep > 0 && depth[last] <= max_depth) {
+            break;
+        }
+        max_depth = depth[last];
+        start = last;
+    }
+
+    return start;
+}
+
+/**
+ * Grows partition 1 from a pseudo-peripheral node until it contains half of the nodes. The priority of a node is the
+ * number of its neighbors inside the grown partition minus the number of its neighbors outside of it, i.e. the
+ * reduction of the edge cut if it is added.
+ *
+ * @param G
+ * @param seed selects the start node
+ * @return the bisection
+ */
+std::vector<PartitionID> graph_growing_initial_partitioner::grow_bisection(graph_access &G, uint seed) {
+    const NodeID n = G.number_of_nodes();
+    std::vector<PartitionID> partition(n, 0);
+    if (n == 0) {
+        return partition;
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<NodeID> order(n);
+    long max_degree = 0;
+    for (NodeID v = 0; v < n; ++v) {
+        order[v] = v;
+        max_degree = std::max<long>(max_degree, G.getNodeDegree(v));
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    bucket_queue queue(n, -max_degree, max_degree);
+    std::vector<NodeID> inside_degree(n, 0);
+    std::size_t next_start = 0;
+
+    for (NodeID claimed = 0; claimed < n / 2; ++claimed) {
+        NodeID u;
+        if (!queue.empty()) {
+            u = queue.pop();
+        } else if (claimed == 0) {
+            u = find_pseudo_peripheral_node(G, order[0]);
+        } else {
+            // the component is exhausted; continue with an unclaimed node
+            while (partition[order[next_start]] == 1) {
+                ++next_start;
+            }
+            u = order[next_start];
+        }
+
+        partition[u] = 1;
+        forall_out_edges(G, e, u) {
+                    NodeID v = G.getEdgeTarget(e);
+                    if (partition[v] == 1) {
+                        continue;
+                    }
+
+                    ++inside_degree[v];
+                    long key = 2 * static_cast<long>(inside_degree[v]) - static_cast<long>(G.getNodeDegree(v));
+                    if (queue.contains(v)) {
+                        queue.change_key(v, key);
+                    } else {
+                        queue.insert(v, key);
+                    }
+                }endfor
+    }
+
+    return partition;
+}
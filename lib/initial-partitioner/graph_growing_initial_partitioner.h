@@ -0,0 +1,32 @@
+#ifndef IMPL_GRAPH_GROWING_INITIAL_PARTITIONER_H
+#define IMPL_GRAPH_GROWING_INITIAL_PARTITIONER_H
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+
+namespace bathesis {
+
+    /**
+     * Greedy graph growing on the data graph.
+     *
+     * Starting from a pseudo-peripheral node, one partition is grown until it contains half of the data nodes; the
+     * next node is always the one that reduces the edge cut the most. Several start nodes are tried in parallel and
+     * the bisection with the lowest partition cost is kept. Each attempt takes O(|E|) time.
+     */
+    class graph_growing_initial_partitioner : public initial_partitioner_interface {
+        uint m_seed;
+
+        int m_attempts;
+
+        NodeID find_pseudo_peripheral_node(graph_access &G, NodeID start);
+
+        std::vector<PartitionID> grow_bisection(graph_access &G, uint seed);
+
+    public:
+        graph_growing_initial_partitioner(uint seed, int attempts = 4);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_GRAPH_GROWING_INITIAL_PARTITIONER_H
@@ -2,19 +2,56 @@
 #include <tools/random_functions.h>
 #include <partition/graph_partitioner.h>
 #include <partition/uncoarsening/refinement/cycle_improvements/cycle_refinement.h>
+#include <algorithm>
+#include <cmath>
 #include <ctime>
+#include <limits>
 
 #include "kahip_initial_partitioner.h"
 #include "balance_configuration.h"
 #include "configuration.h"
+#include "../utils.h"
 
 using namespace bathesis;
 
-kahip_initial_partitioner::kahip_initial_partitioner(ImbalanceType imbalance, int imbalance_level, uint seed, partition_configurator configurator)
+namespace {
+    // Jaccard similarities are mapped to integer edge weights in [1, 1 + jaccard_scale]
+    constexpr double jaccard_scale = 100.0;
+
+    /**
+     * Copies nodes, edges and weights of {@code G} into {@code copy}; all nodes start in partition 0.
+     *
+     * @param G
+     * @param copy
+     * @param edge_weights edge_weights[e] replaces the weight of edge e; empty to keep the weights of {@code G}
+     */
+    void copy_graph(graph_access &G, graph_access &copy, const std::vector<EdgeWeight> &edge_weights) {
+        copy.start_construction(G.number_of_nodes(), G.number_of_edges());
+        forall_nodes(G, v) {
+                    NodeID node = copy.new_node();
+                    copy.setNodeWeight(node, G.getNodeWeight(v));
+                    copy.setPartitionIndex(node, 0);
+
+                    forall_out_edges(G, e, v) {
+                                EdgeID edge = copy.new_edge(node, G.getEdgeTarget(e));
+                                copy.setEdgeWeight(edge, edge_weights.empty() ? G.getEdgeWeight(e) : edge_weights[e]);
+                            }endfor
+                }endfor
+        copy.finish_construction();
+        copy.set_partition_count(G.get_partition_count());
+    }
+}
+
+kahip_initial_partitioner::kahip_initial_partitioner(ImbalanceType imbalance, int imbalance_level, uint seed,
+                                                     partition_configurator configurator, int portfolio_size,
+                                                     edge_weighting weighting)
         : m_imbalance(imbalance),
           m_imbalance_level(imbalance_level),
           m_seed(seed),
-          m_configurator(configurator) {
+          m_configurator(configurator),
+          m_portfolio_size(portfolio_size),
+          m_edge_weighting(weighting) {
+    assert (m_portfolio_size > 0);
 }
 
 void
@@ -38,58 +75,147 @@ kahip_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_
         partition_config.imbalance = m_imbalance;
     }
 
-    // VVV copied from vendor/KaHIP/app/kaffpa.cpp
-    G.set_partition_count(partition_config.k);
+    // compute one bisection per seed and evaluate it with our cost function. KaHIP keeps its random number generator
+    // in global state, hence the calls into KaHIP are serialized by a named critical section, also across subgraphs
+    // that are partitioned concurrently, and the seeds run one after another on the same graph. Seeds are derived
+    // from the position of the subgraph in the recursion tree, i.e. results do not depend on the order in which
+    // subgraphs are processed
+    const std::vector<EdgeWeight> edge_weights = calculate_edge_weights(QG);
+
+    // KaHIP partitions the data graph itself unless its edges are reweighted; the node weights, the partition and
+    // the partition count that KaHIP changes are restored afterwards
+    graph_access G_copy;
+    if (!edge_weights.empty()) {
+        copy_graph(G, G_copy, edge_weights);
+    }
+    graph_access &H = edge_weights.empty() ? G : G_copy;
+
+    std::vector<NodeWeight> node_weights(G.number_of_nodes());
+    forall_nodes(G, node) {
+                node_weights[node] = G.getNodeWeight(node);
+            }endfor
+    const PartitionID partition_count = G.get_partition_count();
+    std::vector<PartitionID> data_partition;
+    if (&H == &G) {
+        data_partition = utils::get_partition(G);
+    }
 
-    balance_configuration bc;
-    bc.configurate_balance(partition_config, G);
+    // VVV copied from vendor/KaHIP/app/kaffpa.cpp
+    H.set_partition_count(partition_config.k);
 
-    //partition_config.seed = 0;
-    partition_config.seed = m_seed; // not from kaffpa.cpp
-    srand(partition_config.seed);
-    random_functions::setSeed(partition_config.seed);
+    std::vector<PartitionID> best_partition;
+    double best_cost = std::numeric_limits<double>::max();
 
-    std::cout << "graph has " << G.number_of_nodes() << " nodes and " << G.number_of_edges() << " edges" << std::endl;
-    // ***************************** perform partitioning ***************************************
+    // with a time limit, keep drawing new seeds until the time is up
     timer t;
     t.restart();
-    graph_partitioner partitioner;
-    quality_metrics qm;
-
-    std::cout << "performing partitioning!" << std::endl;
-    if (partition_config.time_limit == 0) {
-        partitioner.perform_partitioning(partition_config, G);
-    } else {
-        PartitionID *map = new PartitionID[G.number_of_nodes()];
-        EdgeWeight best_cut = std::numeric_limits<EdgeWeight>::max();
-        while (t.elapsed() < partition_config.time_limit) {
-            partition_config.graph_allready_partitioned = false;
-            partitioner.perform_partitioning(partition_config, G);
-            EdgeWeight cut = qm.edge_cut(G);
-            if (cut < best_cut) {
-                best_cut = cut;
-                forall_nodes(G, node){
-                            map[node] = G.getPartitionIndex(node);
-                        }endfor
+    for (uint attempt = 0;
+         attempt < static_cast<uint>(m_portfolio_size) || t.elapsed() < partition_config.time_limit; ++attempt) {
+        PartitionConfig config = partition_config;
+
+#pragma omp critical (kahip)
+        {
+            balance_configuration bc;
+            bc.configurate_balance(config, H);
+
+            //config.seed = 0;
+            config.seed = static_cast<int>(utils::derive_seed(m_seed, QG.branch_id(), attempt)); // not from kaffpa.cpp
+            srand(config.seed);
+            random_functions::setSeed(config.seed);
+
+            // ***************************** perform partitioning ***************************************
+            config.graph_allready_partitioned = false;
+            graph_partitioner partitioner;
+            partitioner.perform_partitioning(config, H);
+
+            if (config.kaffpa_perfectly_balance) {
+                double epsilon = config.imbalance / 100.0;
+                config.upper_bound_partition =
+                        (1 + epsilon) * ceil(config.largest_graph_weight / (double) config.k);
+
+                complete_boundary boundary(&H);
+                boundary.build();
+
+                cycle_refinement cr;
+                cr.perform_refinement(config, H, boundary);
             }
+
+            // configurate_balance() adds the degrees to the node weights
+            forall_nodes(H, node) {
+                        H.setNodeWeight(node, node_weights[node]);
+                    }endfor
         }
 
-        forall_nodes(G, node){
-                    G.setPartitionIndex(node, map[node]);
+        // lowest cost wins, ties are broken by the order of the seeds
+        std::vector<PartitionID> candidate = utils::get_partition(H);
+        double cost = utils::calculate_partition_cost(QG, candidate);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_partition = std::move(candidate);
+        }
+    }
+
+    if (&H == &G) {
+        forall_nodes(G, node) {
+                    G.setPartitionIndex(node, data_partition[node]);
                 }endfor
+        G.set_partition_count(partition_count);
     }
+    utils::set_partition(QG, best_partition);
 
-    if (partition_config.kaffpa_perfectly_balance) {
-        double epsilon = partition_config.imbalance / 100.0;
-        partition_config.upper_bound_partition =
-                (1 + epsilon) * ceil(partition_config.largest_graph_weight / (double) partition_config.k);
+    reporter.initial_partitioning_finish(QG);
+}
 
-        complete_boundary boundary(&G);
-        boundary.build();
+/**
+ * Weights the edges of the data graph by the overlap of the query neighborhoods of their endpoints, see
+ * {@code edge_weighting}. Takes O(sum over all data edges (u, v) of deg(u) + deg(v)) time.
+ *
+ * @param QG
+ * @return edge_weights[e] = weight of edge e of the data graph; empty for unit weights
+ */
+std::vector<EdgeWeight> kahip_initial_partitioner::calculate_edge_weights(query_graph &QG) {
+    if (m_edge_weighting == edge_weighting::unit) {
+        return {};
+    }
 
-        cycle_refinement cr;
-        cr.perform_refinement(partition_config, G, boundary);
+    auto &G = QG.data_graph();
+    std::vector<EdgeWeight> edge_weights(G.number_of_edges());
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID u = 0; u < G.number_of_nodes(); ++u) {
+        forall_out_edges(G, e, u) {
+                    NodeID v = G.getEdgeTarget(e);
+
+                    // sizes of the intersection and the union of the sorted query neighborhoods
+                    node_range neighbors_u = QG.get_adjacent_query_nodes(u);
+                    node_range neighbors_v = QG.get_adjacent_query_nodes(v);
+                    auto first_u = neighbors_u.begin();
+                    auto last_u = neighbors_u.end();
+                    auto first_v = neighbors_v.begin();
+                    auto last_v = neighbors_v.end();
+                    EdgeWeight common = 0;
+                    while (first_u != last_u && first_v != last_v) {
+                        if (*first_u < *first_v) {
+                            ++first_u;
+                        } else if (*first_v < *first_u) {
+                            ++first_v;
+                        } else {
+                            ++common;
+                            ++first_u;
+                            ++first_v;
+                        }
+                    }
+                    auto total = static_cast<EdgeWeight>(neighbors_u.size() + neighbors_v.size()) - common;
+
+                    if (m_edge_weighting == edge_weighting::common_neighbors) {
+                        edge_weights[e] = 1 + common;
+                    } else if (total > 0) {
+                        edge_weights[e] = 1 + static_cast<EdgeWeight>(std::lround(jaccard_scale * common / total));
+                    } else {
+                        edge_weights[e] = 1;
+                    }
+                }endfor
     }
 
-    reporter.initial_partitioning_finish(QG);
+    return edge_weights;
 }
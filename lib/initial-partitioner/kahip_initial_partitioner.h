@@ -9,6 +9,24 @@
 namespace bathesis {
     using partition_configurator = std::function<void(PartitionConfig &)>;
 
+    /**
+     * Edge weights of the data graph that is passed to KaHIP. Besides unit weights, an edge between two data nodes
+     * can be weighted by the number of query nodes they share or by the Jaccard similarity of their query
+     * neighborhoods, such that cutting edges between data nodes with a large overlap is expensive, as it is for the
+     * partition cost.
+     */
+    enum class edge_weighting {
+        unit, common_neighbors, jaccard
+    };
+
+    /**
+     * Bisects the data graph with KaHIP.
+     *
+     * A portfolio of bisections with different seeds is computed and the one with the lowest partition cost is kept.
+     * KaHIP keeps its random number generator in global state, hence calls into KaHIP are serialized, also across
+     * subgraphs that are partitioned concurrently, and the seeds run one after another on the data graph itself, or on
+     * a single reweighted copy of it; a portfolio of N seeds takes about N times as long as a single bisection.
+     */
     class kahip_initial_partitioner : public initial_partitioner_interface {
         ImbalanceType m_imbalance;
 
@@ -18,8 +36,16 @@ namespace bathesis {
 
         partition_configurator m_configurator;
 
+        int m_portfolio_size;
+
+        edge_weighting m_edge_weighting;
+
+        std::vector<EdgeWeight> calculate_edge_weights(query_graph &QG);
+
     public:
-        kahip_initial_partitioner(ImbalanceType imbalance, int imbalance_level, uint seed, partition_configurator configurator);
+        kahip_initial_partitioner(ImbalanceType imbalance, int imbalance_level, uint seed,
+                                  partition_configurator configurator, int portfolio_size = 1,
+                                  edge_weighting weighting = edge_weighting::unit);
 
         void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
     };
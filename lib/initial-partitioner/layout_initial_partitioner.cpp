@@ -0,0 +1,139 @@
+#include "layout_initial_partitioner.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <parallel/algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace bathesis;
+
+namespace {
+    double degree_cost(NodeID degree) {
+        return degree * std::log2(degree + 1.0);
+    }
+
+    double size_cost(EdgeID edges, NodeID partition_size) {
+        if (partition_size == 0) {
+            return 0.0;
+        }
+        return edges * (1 + std::log2(partition_size));
+    }
+}
+
+layout_initial_partitioner::layout_initial_partitioner(int imbalance, int imbalance_level,
+                                                       layout_generator generator)
+        : m_imbalance(imbalance), m_imbalance_level(imbalance_level), m_generator(std::move(generator)) {
+    assert (m_imbalance_level > 0);
+}
+
+void layout_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) {
+    reporter.initial_partitioning_start(QG);
+
+    int imbalance = 3;
+    if (recursion_level % m_imbalance_level == 0) {
+        imbalance = m_imbalance;
+    }
+
+    query_graph &root = QG.root();
+    if (m_root_id != root.graph_id()) {
+        m_layout = m_generator(root.data_graph());
+        m_root_id = root.graph_id();
+
+        // the layout may come from a file, hence check it even in release builds
+        const NodeID num_nodes = root.number_of_data_nodes();
+        bool is_permutation = m_layout.size() == num_nodes;
+        std::vector<char> is_taken(num_nodes, false);
+        for (NodeID v = 0; is_permutation && v < num_nodes; ++v) {
+            NodeID position = m_layout[v];
+            is_permutation = position < num_nodes && !is_taken[position];
+            if (is_permutation) {
+                is_taken[position] = true;
+            }
+        }
+        if (!is_permutation) {
+            m_root_id = 0;
+            throw std::invalid_argument("the layout is not a permutation of the " + std::to_string(num_nodes)
+                                        + " data nodes");
+        }
+    }
+
+    // order the data nodes by the position of their counterparts in the input graph
+    const NodeID n = QG.number_of_data_nodes();
+    std::vector<std::pair<NodeID, NodeID>> positions(n); // (position, data node)
+
+#pragma omp parallel for schedule(static)
+    for (NodeID v = 0; v < n; ++v) {
+        positions[v] = {m_layout[QG.get_root_data_node(v)], v};
+    }
+    __gnu_parallel::sort(positions.begin(), positions.end());
+
+    std::vector<NodeID> order(n);
+    for (NodeID i = 0; i < n; ++i) {
+        order[i] = positions[i].second;
+    }
+
+    NodeID split = find_best_split(QG, order, imbalance);
+    for (NodeID i = 0; i < n; ++i) {
+        QG.set_partition(order[i], i < split ? 0 : 1);
+    }
+
+    reporter.initial_partitioning_finish(QG);
+}
+
+/**
+ * Moves the data nodes from partition 1 to partition 0 in the given order and keeps track of the log-gap partition
+ * cost, which splits into a term that only depends on the number of edges and the size of each partition and a term
+ * that only depends on the degrees of the query nodes, see {@code loggap_cost}.
+ *
+ * @param QG
+ * @param order
+ * @param imbalance
+ * @return number of data nodes in partition 0 with the lowest partition cost
+ */
+NodeID layout_initial_partitioner::find_best_split(query_graph &QG, const std::vector<NodeID> &order, int imbalance) {
+    const NodeID n = static_cast<NodeID>(order.size());
+    const NodeID max_partition_size = std::max((n + 1) / 2, static_cast<NodeID>(n * (100.0 + imbalance) / 200.0));
+    const NodeID num_query_nodes = QG.number_of_query_nodes();
+
+    // initially, all data nodes are in partition 1
+    std::vector<NodeID> degrees_0(num_query_nodes, 0);
+    std::array<EdgeID, 2> edges = {0, QG.number_of_query_edges()};
+    double degree_term = 0.0;
+
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: degree_term)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        degree_term += degree_cost(static_cast<NodeID>(QG.get_adjacent_data_nodes(q).size()));
+    }
+
+    NodeID best_split = n - n / 2;
+    double best_cost = std::numeric_limits<double>::max();
+    for (NodeID split = 0; split <= max_partition_size; ++split) {
+        if (split >= n - max_partition_size) {
+            double cost = size_cost(edges[0], split) + size_cost(edges[1], n - split) - degree_term;
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_split = split;
+            }
+        }
+        if (split == max_partition_size) {
+            break;
+        }
+
+        NodeID v = order[split];
+        for (NodeID q : QG.get_adjacent_query_nodes(v)) {
+            auto degree = static_cast<NodeID>(QG.get_adjacent_data_nodes(q).size());
+
+            degree_term -= degree_cost(degrees_0[q]) + degree_cost(degree - degrees_0[q]);
+            ++degrees_0[q];
+            degree_term += degree_cost(degrees_0[q]) + degree_cost(degree - degrees_0[q]);
+        }
+        edges[0] += QG.get_number_of_adjacent_query_nodes(v);
+        edges[1] -= QG.get_number_of_adjacent_query_nodes(v);
+    }
+
+    return best_split;
+}
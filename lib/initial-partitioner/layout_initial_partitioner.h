@@ -0,0 +1,47 @@
+#ifndef IMPL_LAYOUT_INITIAL_PARTITIONER_H
+#define IMPL_LAYOUT_INITIAL_PARTITIONER_H
+
+#include <functional>
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+
+namespace bathesis {
+    using layout_generator = std::function<std::vector<NodeID>(graph_access &)>;
+
+    /**
+     * Bisects the data nodes by their position in a linear layout of the input graph, e.g. the input order, a layout
+     * read from a file or a BFS order. The layout is generated once per input graph.
+     *
+     * Instead of splitting the layout in the middle, the split point with the lowest log-gap partition cost within
+     * the balance constraint is chosen; all split points are evaluated by a single sweep in O(|E|) time. Useful for
+     * graphs that already come in a partly local order, e.g. URL-sorted web crawls.
+     */
+    class layout_initial_partitioner : public initial_partitioner_interface {
+        int m_imbalance;
+
+        int m_imbalance_level;
+
+        layout_generator m_generator;
+
+        std::uint64_t m_root_id = 0; // graph id of the root graph that m_layout belongs to
+
+        std::vector<NodeID> m_layout;
+
+        NodeID find_best_split(query_graph &QG, const std::vector<NodeID> &order, int imbalance);
+
+    public:
+        /**
+         * @param imbalance
+         * @param imbalance_level
+         * @param generator returns a linear layout of the input graph, layout[data node] = position
+         * @throws std::invalid_argument from {@code perform_partitioning()} if the layout is not a permutation of
+         * the data nodes
+         */
+        layout_initial_partitioner(int imbalance, int imbalance_level, layout_generator generator);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_LAYOUT_INITIAL_PARTITIONER_H
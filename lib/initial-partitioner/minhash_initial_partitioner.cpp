@@ -0,0 +1,86 @@
+#include "minhash_initial_partitioner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <parallel/algorithm>
+
+#include "../utils.h"
+
+using namespace bathesis;
+
+namespace {
+    /**
+     * splitmix64 finalizer applied to the node id, one hash function per seed.
+     */
+    std::uint64_t hash(std::uint64_t seed, NodeID node) {
+        std::uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (static_cast<std::uint64_t>(node) + 1);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+minhash_initial_partitioner::minhash_initial_partitioner(uint seed, int number_of_hashes)
+        : m_seed(seed), m_number_of_hashes(number_of_hashes) {
+    assert (m_number_of_hashes > 0);
+}
+
+void minhash_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) {
+    reporter.initial_partitioning_start(QG);
+
+    const NodeID n = QG.number_of_data_nodes();
+    const NodeID num_query_nodes = QG.number_of_query_nodes();
+    const auto k = static_cast<std::size_t>(m_number_of_hashes);
+
+    // the hash functions do not depend on the subgraph: the query neighborhoods of the data nodes are the same on all
+    // recursion levels, hence the subgraphs keep the order of their parent and the recursion as a whole reproduces
+    // the shingle ordering of the input graph
+    std::vector<std::uint64_t> seeds(k);
+    for (std::size_t i = 0; i < k; ++i) {
+        seeds[i] = utils::derive_seed(m_seed, 1, static_cast<uint>(i));
+    }
+
+    // hash values of the query nodes, hashes[q * k + i] = i-th hash of q
+    std::vector<std::uint64_t> hashes(static_cast<std::size_t>(num_query_nodes) * k);
+
+#pragma omp parallel for schedule(static)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        for (std::size_t i = 0; i < k; ++i) {
+            hashes[q * k + i] = hash(seeds[i], q);
+        }
+    }
+
+    // signatures[v * k + i] = minimum of the i-th hash over the query neighbors of v; nodes without query neighbors
+    // keep the maximum signature and end up in the second half
+    std::vector<std::uint64_t> signatures(static_cast<std::size_t>(n) * k, std::numeric_limits<std::uint64_t>::max());
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID v = 0; v < n; ++v) {
+        for (NodeID q : QG.get_adjacent_query_nodes(v)) {
+            for (std::size_t i = 0; i < k; ++i) {
+                signatures[v * k + i] = std::min(signatures[v * k + i], hashes[q * k + i]);
+            }
+        }
+    }
+
+    // shingle ordering: sort by signature, break ties by node id
+    std::vector<NodeID> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    __gnu_parallel::sort(order.begin(), order.end(), [&signatures, k](NodeID left, NodeID right) {
+        auto first_left = signatures.begin() + left * k;
+        auto first_right = signatures.begin() + right * k;
+        auto mismatch = std::mismatch(first_left, first_left + k, first_right);
+        if (mismatch.first != first_left + k) {
+            return *mismatch.first < *mismatch.second;
+        }
+        return left < right;
+    });
+
+    for (NodeID i = 0; i < n; ++i) {
+        QG.set_partition(order[i], i < n - n / 2 ? 0 : 1);
+    }
+
+    reporter.initial_partitioning_finish(QG);
+}
@@ -0,0 +1,28 @@
+#ifndef IMPL_MINHASH_INITIAL_PARTITIONER_H
+#define IMPL_MINHASH_INITIAL_PARTITIONER_H
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+
+namespace bathesis {
+
+    /**
+     * Shingle ordering: sorts the data nodes by a MinHash signature of their query neighborhoods and splits the order
+     * at the median.
+     *
+     * Data nodes with similar query neighborhoods are likely to agree on their signature and thus end up in the same
+     * partition. Takes O(|E| + n log n) time.
+     */
+    class minhash_initial_partitioner : public initial_partitioner_interface {
+        uint m_seed;
+
+        int m_number_of_hashes;
+
+    public:
+        minhash_initial_partitioner(uint seed, int number_of_hashes = 2);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_MINHASH_INITIAL_PARTITIONER_H
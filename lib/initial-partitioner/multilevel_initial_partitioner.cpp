@@ -0,0 +1,196 @@
+#include "multilevel_initial_partitioner.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#include "../utils.h"
+
+using namespace bathesis;
+
+template<typename CostModel>
+multilevel_initial_partitioner<CostModel>::multilevel_initial_partitioner(int imbalance, int imbalance_level, uint seed,
+                                                                          NodeID contraction_limit, int attempts,
+                                                                          int rounds_per_level)
+        : m_imbalance(imbalance),
+          m_imbalance_level(imbalance_level),
+          m_seed(seed),
+          m_contraction_limit(contraction_limit),
+          m_attempts(attempts),
+          m_rounds_per_level(rounds_per_level) {
+    assert (m_imbalance_level > 0);
+    assert (m_attempts > 0);
+}
+
+template<typename CostModel>
+void multilevel_initial_partitioner<CostModel>::perform_partitioning(query_graph &QG, long recursion_level,
+                                                                     reporter &reporter) {
+    reporter.initial_partitioning_start(QG);
+
+    int imbalance = 3;
+    if (recursion_level % m_imbalance_level == 0) {
+        imbalance = m_imbalance;
+    }
+
+    // all nodes start in the same partition, hence the coarsener may contract any pair of data nodes
+    utils::reset_partition(QG);
+    std::vector<std::vector<NodeID>> maps;
+    auto hierarchy = build_hierarchy(QG, maps);
+
+    bisect_coarsest_graph(hierarchy.back(), QG.branch_id(), imbalance);
+
+    // project the bisection to the finer levels and refine it on each level
+    while (hierarchy.size() > 1) {
+        hierarchy.back().project_partition(hierarchy[hierarchy.size() - 2], maps.back());
+        hierarchy.pop_back();
+        maps.pop_back();
+        m_refiner.perform_refinement(hierarchy.back(), m_rounds_per_level, imbalance);
+    }
+
+    auto &finest = hierarchy.front();
+    for (NodeID v = 0; v < QG.number_of_data_nodes(); ++v) {
+        QG.set_partition(v, finest.get_partition(v));
+    }
+
+    reporter.initial_partitioning_finish(QG);
+}
+
+/**
+ * Coarsens the root graph from scratch and keeps its maps; subgraphs of the root graph are coarsened along those maps.
+ *
+ * @param QG
+ * @param maps output: maps[i] maps the data nodes of level i to the data nodes of level i + 1
+ * @return the hierarchy; level 0 is the uncontracted graph of {@code QG}
+ */
+template<typename CostModel>
+std::vector<weighted_query_graph>
+multilevel_initial_partitioner<CostModel>::build_hierarchy(query_graph &QG, std::vector<std::vector<NodeID>> &maps) {
+    if (&QG.root() == &QG) {
+        auto hierarchy = m_coarsener.build_hierarchy(weighted_query_graph(QG), m_contraction_limit, maps);
+        m_root_id = QG.graph_id();
+        m_root_maps = maps;
+        return hierarchy;
+    }
+
+    // the root graph was bisected by another partitioner, or it was too small to be coarsened
+    query_graph &root = QG.root();
+    if (m_root_id != root.graph_id() || m_root_maps.empty()
+        || m_root_maps.front().size() != root.number_of_data_nodes()) {
+        return m_coarsener.build_hierarchy(weighted_query_graph(QG), m_contraction_limit, maps);
+    }
+
+    std::vector<NodeID> labels(QG.number_of_data_nodes());
+    for (NodeID v = 0; v < labels.size(); ++v) {
+        labels[v] = QG.get_root_data_node(v);
+    }
+    return m_coarsener.restrict_hierarchy(weighted_query_graph(QG), std::move(labels), m_root_maps,
+                                          m_contraction_limit, maps);
+}
+
+/**
+ * Computes several bisections of the coarsest graph and keeps the one with the lowest partition cost after
+ * refinement.
+ *
+ * @param G
+ * @param branch_id used to derive the seeds of the attempts
+ * @param imbalance
+ */
+template<typename CostModel>
+void multilevel_initial_partitioner<CostModel>::bisect_coarsest_graph(weighted_query_graph &G, std::uint64_t branch_id,
+                                                                      int imbalance) {
+    std::vector<PartitionID> best_partition;
+    double best_cost = std::numeric_limits<double>::max();
+
+    for (int attempt = 0; attempt < m_attempts; ++attempt) {
+        grow_bisection(G, utils::derive_seed(m_seed, branch_id, static_cast<uint>(attempt)));
+        m_refiner.perform_refinement(G, m_rounds_per_level, imbalance);
+
+        double cost = G.calculate_partition_cost<CostModel>();
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_partition.resize(G.number_of_data_nodes());
+            for (NodeID v = 0; v < G.number_of_data_nodes(); ++v) {
+                best_partition[v] = G.get_partition(v);
+            }
+        }
+    }
+
+    for (NodeID v = 0; v < G.number_of_data_nodes(); ++v) {
+        G.set_partition(v, best_partition[v]);
+    }
+}
+
+/**
+ * Grows partition 1 by breadth-first search from a random data node until it holds half of the total node weight;
+ * two data nodes are adjacent if they share a query node. All other nodes are assigned to partition 0.
+ *
+ * @param G
+ * @param seed
+ */
+template<typename CostModel>
+void multilevel_initial_partitioner<CostModel>::grow_bisection(weighted_query_graph &G, uint seed) {
+    const NodeID n = G.number_of_data_nodes();
+    if (n == 0) {
+        return;
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<NodeID> order(n);
+    for (NodeID v = 0; v < n; ++v) {
+        order[v] = v;
+        G.set_partition(v, 0);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    auto weights = G.calculate_partition_weights();
+    const NodeID target_weight = (weights[0] + weights[1]) / 2;
+    NodeID weight = 0;
+
+    std::vector<bool> visited_data_node(n, false);
+    std::vector<bool> visited_query_node(G.number_of_query_nodes(), false);
+    std::vector<NodeID> queue;
+    std::size_t head = 0;
+    std::size_t next_start = 0;
+
+    while (weight < target_weight) {
+        // restart from a random unvisited node if the current component is exhausted
+        if (head == queue.size()) {
+            while (next_start < n && visited_data_node[order[next_start]]) {
+                ++next_start;
+            }
+            if (next_start == n) {
+                break;
+            }
+            visited_data_node[order[next_start]] = true;
+            queue.push_back(order[next_start]);
+        }
+
+        NodeID u = queue[head++];
+        if (weight + G.get_node_weight(u) > target_weight && weight > 0) {
+            continue;
+        }
+        G.set_partition(u, 1);
+        weight += G.get_node_weight(u);
+
+        for (EdgeID e = G.get_first_data_edge(u); e < G.get_first_invalid_data_edge(u); ++e) {
+            NodeID q = G.get_data_edge_target(e);
+            if (visited_query_node[q]) {
+                continue;
+            }
+            visited_query_node[q] = true;
+
+            for (EdgeID f = G.get_first_query_edge(q); f < G.get_first_invalid_query_edge(q); ++f) {
+                NodeID v = G.get_query_edge_target(f);
+                if (!visited_data_node[v]) {
+                    visited_data_node[v] = true;
+                    queue.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+namespace bathesis {
+    template class multilevel_initial_partitioner<loggap_cost>;
+    template class multilevel_initial_partitioner<mla_cost>;
+}
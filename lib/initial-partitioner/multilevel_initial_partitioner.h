@@ -0,0 +1,61 @@
+#ifndef IMPL_MULTILEVEL_INITIAL_PARTITIONER_H
+#define IMPL_MULTILEVEL_INITIAL_PARTITIONER_H
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+#include "../coarsening/overlap_coarsener.h"
+#include "../refinement/weighted_lp_refiner.h"
+
+namespace bathesis {
+
+    /**
+     * Multilevel bisection that works directly on the query graph, i.e. optimizes the partition cost instead of the
+     * edge cut of the data graph.
+     *
+     * Data nodes with a high overlap of their query neighborhoods are contracted until the graph is small. The
+     * coarsest graph is bisected several times by growing one partition from a random data node along shared query
+     * nodes; the bisection with the lowest partition cost after refinement is kept. It is then projected to the
+     * finer levels and refined by label propagation on each level.
+     *
+     * The hierarchy of the graph at the root of the recursion is kept; subgraphs are coarsened by restricting it to
+     * their data nodes, as in nested dissection, instead of computing new matchings on every recursion level.
+     *
+     * @tparam CostModel separable estimate of the cost of a query node, see {@code weighted_lp_refiner}
+     */
+    template<typename CostModel = loggap_cost>
+    class multilevel_initial_partitioner : public initial_partitioner_interface {
+        int m_imbalance;
+
+        int m_imbalance_level;
+
+        uint m_seed;
+
+        NodeID m_contraction_limit;
+
+        int m_attempts;
+
+        int m_rounds_per_level;
+
+        overlap_coarsener m_coarsener;
+
+        weighted_lp_refiner<CostModel> m_refiner;
+
+        std::uint64_t m_root_id = 0; // graph id of the root graph that m_root_maps belong to
+
+        std::vector<std::vector<NodeID>> m_root_maps;
+
+        std::vector<weighted_query_graph> build_hierarchy(query_graph &QG, std::vector<std::vector<NodeID>> &maps);
+
+        void grow_bisection(weighted_query_graph &G, uint seed);
+
+        void bisect_coarsest_graph(weighted_query_graph &G, std::uint64_t branch_id, int imbalance);
+
+    public:
+        multilevel_initial_partitioner(int imbalance, int imbalance_level, uint seed, NodeID contraction_limit = 256,
+                                       int attempts = 8, int rounds_per_level = 10);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_MULTILEVEL_INITIAL_PARTITIONER_H
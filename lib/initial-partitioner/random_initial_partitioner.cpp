@@ -1,4 +1,5 @@
 #include "random_initial_partitioner.h"
+#include "../utils.h"
 
 #include <algorithm>
 #include <ctime>
@@ -14,22 +15,17 @@ void random_initial_partitioner::perform_partitioning(query_graph &QG,
                                                       reporter &reporter) {
     reporter.initial_partitioning_start(QG);
 
-    auto &G = QG.data_graph();
-
-    std::srand(m_seed);
-
-    G.set_partition_count(2);
-    std::vector<NodeID> random(G.number_of_nodes());
-    for (NodeID i = 0; i < G.number_of_nodes() / 2; ++i) {
+    std::vector<NodeID> random(QG.number_of_data_nodes());
+    for (NodeID i = 0; i < QG.number_of_data_nodes() / 2; ++i) {
         random[i] = 1;
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
+    // private generator, seeded by the position of QG in the recursion tree
+    std::mt19937 g(utils::derive_seed(m_seed, QG.branch_id()));
     std::shuffle(random.begin(), random.end(), g);
 
-    for (NodeID n = 0; n < G.number_of_nodes(); ++n) {
-        G.setPartitionIndex(n, random[n]);
+    for (NodeID n = 0; n < QG.number_of_data_nodes(); ++n) {
+        QG.set_partition(n, random[n]);
     }
 
     reporter.initial_partitioning_finish(QG);
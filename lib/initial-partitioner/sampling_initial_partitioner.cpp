@@ -0,0 +1,193 @@
+#include "sampling_initial_partitioner.h"
+
+#include <algorithm>
+#include <array>
+#include <parallel/algorithm>
+#include <random>
+
+#include "../utils.h"
+#include "report/null_reporter.h"
+
+using namespace bathesis;
+
+sampling_initial_partitioner::sampling_initial_partitioner(initial_partitioner_interface &partitioner, uint seed,
+                                                           NodeID sample_size)
+        : m_partitioner(partitioner), m_seed(seed), m_sample_size(sample_size) {
+    assert (m_sample_size > 0);
+}
+
+void sampling_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) {
+    const NodeID n = QG.number_of_data_nodes();
+    if (n <= m_sample_size) {
+        m_partitioner.perform_partitioning(QG, recursion_level, reporter);
+        return;
+    }
+
+    reporter.initial_partitioning_start(QG);
+
+    // Step 1: Bisect the sample with every other data node contracted onto its closest sampled node, such that the
+    // sample keeps the connectivity of the data graph. The bisection of the sample is reported as part of this
+    // bisection, hence the wrapped partitioner reports to a null reporter
+    std::vector<NodeID> sample = draw_sample(QG);
+    std::vector<NodeID> cluster = assign_clusters(QG, sample);
+    const auto number_of_clusters = static_cast<NodeID>(sample.size());
+    std::vector<PartitionID> sampled_partition;
+    {
+        query_graph sampled_graph;
+        QG.build_contracted_graph(cluster, number_of_clusters, sampled_graph);
+        null_reporter sample_reporter;
+        m_partitioner.perform_partitioning(sampled_graph, recursion_level, sample_reporter);
+        sampled_partition = utils::get_partition(sampled_graph);
+    }
+
+    // every data node provisionally joins the partition of its cluster; sampled data nodes keep it, the others stay
+    // unassigned until step 3
+    const PartitionID unassigned = 2;
+    std::vector<PartitionID> provisional(n, unassigned);
+    std::vector<PartitionID> partition(n, unassigned);
+    std::array<NodeID, 2> partition_sizes = {0, 0};
+
+#pragma omp parallel for schedule(static)
+    for (NodeID v = 0; v < n; ++v) {
+        if (cluster[v] < number_of_clusters) {
+            provisional[v] = sampled_partition[cluster[v]];
+        }
+    }
+    for (NodeID i = 0; i < number_of_clusters; ++i) {
+        partition[sample[i]] = sampled_partition[i];
+        ++partition_sizes[sampled_partition[i]];
+    }
+
+    // Step 2: Every query node votes with the share of its neighbors in partition 1 minus the share in partition 0
+    // under the provisional partition; the votes of its query neighbors decide where a data node leans
+    std::vector<double> votes(n, 0.0);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID q = 0; q < QG.number_of_query_nodes(); ++q) {
+        std::array<NodeID, 2> assigned_degrees = {0, 0};
+        for (NodeID v : QG.get_adjacent_data_nodes(q)) {
+            PartitionID p = provisional[v];
+            if (p != unassigned) {
+                ++assigned_degrees[p];
+            }
+        }
+
+        NodeID assigned_degree = assigned_degrees[0] + assigned_degrees[1];
+        if (assigned_degree == 0) {
+            continue;
+        }
+
+        double vote = (static_cast<double>(assigned_degrees[1]) - assigned_degrees[0]) / assigned_degree;
+        for (NodeID v : QG.get_adjacent_data_nodes(q)) {
+            if (partition[v] == unassigned) {
+#pragma omp atomic
+                votes[v] += vote;
+            }
+        }
+    }
+
+    // Step 3: Fill partition 0 up to half of the data nodes with the data nodes that lean most towards it
+    std::vector<NodeID> remaining;
+    remaining.reserve(n - sample.size());
+    for (NodeID v = 0; v < n; ++v) {
+        if (partition[v] == unassigned) {
+            remaining.push_back(v);
+        }
+    }
+    __gnu_parallel::sort(remaining.begin(), remaining.end(), [&](NodeID left, NodeID right) {
+        if (votes[left] != votes[right]) {
+            return votes[left] < votes[right];
+        }
+        if (provisional[left] != provisional[right]) {
+            return provisional[left] < provisional[right];
+        }
+        return left < right;
+    });
+
+    const NodeID target_size = n - n / 2;
+    const NodeID missing = target_size > partition_sizes[0] ? target_size - partition_sizes[0] : 0;
+
+#pragma omp parallel for schedule(static)
+    for (NodeID i = 0; i < remaining.size(); ++i) {
+        partition[remaining[i]] = i < missing ? 0 : 1;
+    }
+    utils::set_partition(QG, partition);
+
+    reporter.initial_partitioning_finish(QG);
+}
+
+/**
+ * Draws every data node independently with the same probability, seeded by the position of QG in the recursion tree.
+ *
+ * @param QG
+ * @return sampled data nodes in ascending order
+ */
+std::vector<NodeID> sampling_initial_partitioner::draw_sample(query_graph &QG) {
+    std::mt19937 g(utils::derive_seed(m_seed, QG.branch_id()));
+    std::bernoulli_distribution coin(static_cast<double>(m_sample_size) / QG.number_of_data_nodes());
+
+    std::vector<NodeID> sample;
+    sample.reserve(m_sample_size);
+    for (NodeID v = 0; v < QG.number_of_data_nodes(); ++v) {
+        if (coin(g)) {
+            sample.push_back(v);
+        }
+    }
+    return sample;
+}
+
+/**
+ * Assigns every data node to its closest sampled data node in the data graph, ties are broken by the smaller
+ * position in the sample. Round i assigns the data nodes at distance i in parallel, hence this takes O(r * m) time
+ * for sample radius r, which is small for a uniform sample. Data nodes without a sampled node in their connected
+ * component are left out.
+ *
+ * @param QG
+ * @param sample sampled data nodes
+ * @return cluster[data node] = position of its sampled data node in {@code sample}, {@code sample.size()} if left out
+ */
+std::vector<NodeID> sampling_initial_partitioner::assign_clusters(query_graph &QG, const std::vector<NodeID> &sample) {
+    const NodeID n = QG.number_of_data_nodes();
+    const auto left_out = static_cast<NodeID>(sample.size());
+
+    std::vector<NodeID> cluster(n, left_out);
+    for (NodeID i = 0; i < sample.size(); ++i) {
+        cluster[sample[i]] = i;
+    }
+
+    std::vector<NodeID> remaining;
+    remaining.reserve(n - sample.size());
+    for (NodeID v = 0; v < n; ++v) {
+        if (cluster[v] == left_out) {
+            remaining.push_back(v);
+        }
+    }
+
+    // the data neighbors of a data node are the neighbors of its query node, see construct_query_edges()
+    std::vector<NodeID> closest(remaining.size());
+    while (!remaining.empty()) {
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeID i = 0; i < remaining.size(); ++i) {
+            NodeID best = left_out;
+            for (NodeID neighbor_id : QG.get_adjacent_data_nodes(QG.get_root_data_node(remaining[i]))) {
+                best = std::min(best, cluster[neighbor_id]);
+            }
+            closest[i] = best;
+        }
+
+        NodeID still_remaining = 0;
+        for (NodeID i = 0; i < remaining.size(); ++i) {
+            if (closest[i] != left_out) {
+                cluster[remaining[i]] = closest[i];
+            } else {
+                remaining[still_remaining++] = remaining[i];
+            }
+        }
+        if (still_remaining == remaining.size()) { // no sampled node in reach
+            break;
+        }
+        remaining.resize(still_remaining);
+    }
+
+    return cluster;
+}
@@ -0,0 +1,41 @@
+#ifndef IMPL_SAMPLING_INITIAL_PARTITIONER_H
+#define IMPL_SAMPLING_INITIAL_PARTITIONER_H
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+
+namespace bathesis {
+
+    /**
+     * Bisects a uniform sample of the data nodes with another initial partitioner and projects the bisection onto
+     * the remaining data nodes.
+     *
+     * The subgraph induced by a uniform sample with probability p only keeps about p^2 of the data edges, hence every
+     * other data node is contracted onto its closest sampled data node instead; the contracted graph keeps the
+     * connectivity of the data graph, with cluster sizes as node weights. Every data node provisionally joins the
+     * partition of its cluster, then every query node votes for the partition that holds the majority of its
+     * neighbors; the data nodes outside the sample are ordered by the votes of their query neighbors and the ones
+     * that lean most towards partition 0 fill it up to half of the data nodes. Graphs with at most
+     * {@code sample_size} data nodes are passed on unchanged, hence the time of the wrapped partitioner only depends
+     * on the sample size.
+     */
+    class sampling_initial_partitioner : public initial_partitioner_interface {
+        initial_partitioner_interface &m_partitioner;
+
+        uint m_seed;
+
+        NodeID m_sample_size;
+
+        std::vector<NodeID> draw_sample(query_graph &QG);
+
+        std::vector<NodeID> assign_clusters(query_graph &QG, const std::vector<NodeID> &sample);
+
+    public:
+        sampling_initial_partitioner(initial_partitioner_interface &partitioner, uint seed,
+                                     NodeID sample_size = 1 << 20);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_SAMPLING_INITIAL_PARTITIONER_H
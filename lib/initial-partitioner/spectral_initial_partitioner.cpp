@@ -0,0 +1,158 @@
+#include "spectral_initial_partitioner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "../utils.h"
+
+using namespace bathesis;
+
+namespace {
+    double dot(const std::vector<double> &x, const std::vector<double> &y) {
+        double result = 0.0;
+
+#pragma omp parallel for schedule(static) reduction(+: result)
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            result += x[i] * y[i];
+        }
+        return result;
+    }
+
+    void normalize(std::vector<double> &x) {
+        double norm = std::sqrt(dot(x, x));
+        if (norm > 0.0) {
+#pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                x[i] /= norm;
+            }
+        }
+    }
+
+    /**
+     * Removes the component of {@code x} along the unit vector {@code u} and normalizes the result.
+     *
+     * @param x
+     * @param u
+     */
+    void orthonormalize(std::vector<double> &x, const std::vector<double> &u) {
+        double projection = dot(x, u);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            x[i] -= projection * u[i];
+        }
+        normalize(x);
+    }
+}
+
+spectral_initial_partitioner::spectral_initial_partitioner(uint seed, int max_iterations, double tolerance)
+        : m_seed(seed), m_max_iterations(max_iterations), m_tolerance(tolerance) {
+    assert (m_max_iterations > 0);
+}
+
+/**
+ * Let B be the incidence matrix between query nodes and data nodes. The co-occurrence operator A = B^T B has
+ * A[u][v] = number of query nodes adjacent to both u and v and degrees D[v] = sum of the degrees of the query
+ * neighbors of v. The normalized operator D^(-1/2) A D^(-1/2) is positive semidefinite with largest eigenvalue 1 and
+ * eigenvector D^(1/2) 1, hence power iteration orthogonal to that vector converges to the second eigenvector y, and
+ * D^(-1/2) y approximates the Fiedler vector of the normalized Laplacian.
+ *
+ * @param QG
+ * @param recursion_level
+ * @param reporter
+ */
+void spectral_initial_partitioner::perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) {
+    reporter.initial_partitioning_start(QG);
+
+    const NodeID n = QG.number_of_data_nodes();
+    const NodeID num_query_nodes = QG.number_of_query_nodes();
+
+    // scale[v] = D[v]^(-1/2), 0 for data nodes without query neighbors
+    std::vector<double> scale(n, 0.0);
+    std::vector<double> trivial(n, 0.0); // unit eigenvector of the largest eigenvalue
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID v = 0; v < n; ++v) {
+        EdgeID degree = 0;
+        for (NodeID q : QG.get_adjacent_query_nodes(v)) {
+            degree += QG.get_adjacent_data_nodes(q).size();
+        }
+        if (degree > 0) {
+            scale[v] = 1.0 / std::sqrt(static_cast<double>(degree));
+            trivial[v] = std::sqrt(static_cast<double>(degree));
+        }
+    }
+    normalize(trivial);
+
+    // random start vector, seeded by the position of QG in the recursion tree
+    std::vector<double> y(n);
+    {
+        std::mt19937 g(utils::derive_seed(m_seed, QG.branch_id()));
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+        for (NodeID v = 0; v < n; ++v) {
+            y[v] = scale[v] > 0.0 ? distribution(g) : 0.0;
+        }
+    }
+    orthonormalize(y, trivial);
+
+    std::vector<double> query_sums(num_query_nodes);
+    std::vector<double> next(n);
+
+    for (int iteration = 0; iteration < m_max_iterations; ++iteration) {
+        // next = D^(-1/2) B^T B D^(-1/2) y
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeID q = 0; q < num_query_nodes; ++q) {
+            double sum = 0.0;
+            for (NodeID v : QG.get_adjacent_data_nodes(q)) {
+                sum += scale[v] * y[v];
+            }
+            query_sums[q] = sum;
+        }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeID v = 0; v < n; ++v) {
+            double sum = 0.0;
+            for (NodeID q : QG.get_adjacent_query_nodes(v)) {
+                sum += query_sums[q];
+            }
+            next[v] = scale[v] * sum;
+        }
+        orthonormalize(next, trivial);
+
+        double change = 0.0;
+
+#pragma omp parallel for schedule(static) reduction(+: change)
+        for (NodeID v = 0; v < n; ++v) {
+            change += (next[v] - y[v]) * (next[v] - y[v]);
+        }
+
+        std::swap(y, next);
+        if (std::sqrt(change) < m_tolerance) {
+            break;
+        }
+    }
+
+    // Fiedler vector x = D^(-1/2) y, split at the median
+    std::vector<double> fiedler(n);
+
+#pragma omp parallel for schedule(static)
+    for (NodeID v = 0; v < n; ++v) {
+        fiedler[v] = scale[v] * y[v];
+    }
+
+    std::vector<NodeID> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    const NodeID median = n - n / 2;
+    std::nth_element(order.begin(), order.begin() + median, order.end(), [&fiedler](NodeID left, NodeID right) {
+        return fiedler[left] < fiedler[right] || (fiedler[left] == fiedler[right] && left < right);
+    });
+
+#pragma omp parallel for schedule(static)
+    for (NodeID i = 0; i < n; ++i) {
+        QG.set_partition(order[i], i < median ? 0 : 1);
+    }
+
+    reporter.initial_partitioning_finish(QG);
+}
@@ -0,0 +1,31 @@
+#ifndef IMPL_SPECTRAL_INITIAL_PARTITIONER_H
+#define IMPL_SPECTRAL_INITIAL_PARTITIONER_H
+
+#include "initial_partitioner_interface.h"
+#include "report/reporter.h"
+
+namespace bathesis {
+
+    /**
+     * Spectral bisection: approximates the Fiedler vector of the query co-occurrence graph of the data nodes and
+     * splits the data nodes at its median.
+     *
+     * Two data nodes are similar if they share query neighbors. The Fiedler vector is computed by power iteration on
+     * the normalized co-occurrence operator, which is applied through the query edges without building the
+     * co-occurrence graph. Every iteration takes O(|E|) time and is parallel.
+     */
+    class spectral_initial_partitioner : public initial_partitioner_interface {
+        uint m_seed;
+
+        int m_max_iterations;
+
+        double m_tolerance;
+
+    public:
+        spectral_initial_partitioner(uint seed, int max_iterations = 300, double tolerance = 1e-6);
+
+        void perform_partitioning(query_graph &QG, long recursion_level, reporter &reporter) override;
+    };
+}
+
+#endif // IMPL_SPECTRAL_INITIAL_PARTITIONER_H
@@ -7,24 +7,22 @@
 
 #include <fstream>
 #include "refiner_interface.h"
+#include "cost_models.h"
 #include "../data-structure/query_graph.h"
 
 namespace bathesis {
 
+    template<typename CostModel = loggap_cost>
     class basic_refiner : public refiner_interface {
         std::array<NodeID, 2> m_partition_sizes;
 
-        std::vector<double> calculate_gain_values();
-
-        double calculate_node_cost(NodeID node);
-
-        double calculate_node_cost(const std::array<NodeID, 2> &degrees);
-
-        double calculate_node_cost(const std::array<NodeID, 2> &partition_sizes, const std::array<NodeID, 2> &degrees);
+        numa_vector<double> calculate_gain_values();
 
     protected:
         NodeID perform_refinement_iteration(int nth_iteration, int imbalance);
 
+        double calculate_partition_cost();
+
     public:
         basic_refiner(int imbalance = 3, int imbalance_level = 1);
     };
@@ -0,0 +1,241 @@
+#include <algorithm>
+
+#include "batch_refiner.h"
+#include "../utils.h"
+
+using namespace bathesis;
+
+template<typename CostModel>
+batch_refiner<CostModel>::batch_refiner(int imbalance, int imbalance_level, int max_validation_rounds)
+        : refiner_interface(imbalance, imbalance_level), m_max_validation_rounds(max_validation_rounds) {
+}
+
+template<typename CostModel>
+NodeID batch_refiner<CostModel>::perform_refinement_iteration(int nth_iteration, int imbalance) {
+    m_partition_sizes = m_query_graph->count_partition_sizes();
+
+    // calculate gain values for every data node from a snapshot of the partition
+    auto gains = calculate_gain_values();
+
+    // S[p][i] is moved from partition p to partition 1 - p; both lists always have the same size to keep the balance
+    auto S = utils::select_swap_candidates(*m_query_graph, gains);
+
+    // re-evaluate the moves given the other moves of the batch and drop the ones that turned out to be negative
+    numa_vector<double> batch_gains(gains);
+    for (int round = 0; round < m_max_validation_rounds && !S[0].empty(); ++round) {
+        std::vector<NodeID> batch(S[0]);
+        batch.insert(batch.end(), S[1].begin(), S[1].end());
+
+        auto real_gains = calculate_batch_gain_values(batch);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            batch_gains[batch[i]] = real_gains[i];
+        }
+
+        bool dropped = false;
+        for (PartitionID p = 0; p < 2; ++p) {
+            auto end = std::remove_if(S[p].begin(), S[p].end(), [&](NodeID v) { return batch_gains[v] <= 0; });
+            dropped |= (end != S[p].end());
+            S[p].erase(end, S[p].end());
+        }
+        if (!dropped) {
+            break;
+        }
+
+        // restore the balance by dropping the worst moves of the larger list
+        auto limit = std::min(S[0].size(), S[1].size());
+        for (PartitionID p = 0; p < 2; ++p) {
+            std::stable_sort(S[p].begin(), S[p].end(), [&](NodeID left, NodeID right) {
+                return batch_gains[left] > batch_gains[right];
+            });
+            S[p].resize(limit);
+        }
+    }
+
+    // the re-evaluated gain values are only estimates for a changing batch; make sure that the batch as a whole
+    // improves the partition and shrink it otherwise
+    std::vector<NodeID> batch;
+    double batch_gain = 0.0;
+    while (!S[0].empty()) {
+        batch.assign(S[0].begin(), S[0].end());
+        batch.insert(batch.end(), S[1].begin(), S[1].end());
+
+        batch_gain = calculate_batch_gain(batch);
+        if (batch_gain > 0) {
+            break;
+        }
+
+        auto limit = S[0].size() / 2;
+        S[0].resize(limit);
+        S[1].resize(limit);
+        batch.clear();
+    }
+
+    if (batch.empty()) {
+        return 0;
+    }
+
+    // commit the batch
+    std::vector<bool> is_boundary(batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        is_boundary[i] = m_query_graph->is_boundary_node(batch[i]);
+    }
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        NodeID v = batch[i];
+        PartitionID p = m_query_graph->get_partition(v);
+        m_query_graph->set_partition(v, 1 - p);
+        m_reporter->refinement_move_node(*m_query_graph, v, p, batch_gains[v], 0, 0, is_boundary[i]);
+    }
+
+    return static_cast<NodeID>(batch.size());
+}
+
+/**
+ * Calculates the gain value of every data node, i.e. the cost improvement if only this node is moved to the other
+ * partition.
+ *
+ * @return
+ */
+template<typename CostModel>
+numa_vector<double> batch_refiner<CostModel>::calculate_gain_values() {
+    const NodeID num_query_nodes = m_query_graph->number_of_query_nodes();
+    const NodeID num_data_nodes = m_query_graph->number_of_data_nodes();
+
+    m_degrees.resize(num_query_nodes);
+
+    // contribution[q][p]: cost difference of q when an adjacent node is moved out of partition p, relative to the
+    // cost difference when a nonadjacent node is moved out of partition p
+    std::vector<std::array<double, 2>> contribution(num_query_nodes);
+    double nonadjacent_base_cost_0 = 0.0;
+    double nonadjacent_base_cost_1 = 0.0;
+
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: nonadjacent_base_cost_0, nonadjacent_base_cost_1)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        auto &degrees = m_degrees[q];
+        degrees = m_query_graph->count_query_node_degrees(q);
+        auto move_contribution = calculate_move_cost_contribution<CostModel>(m_partition_sizes, degrees);
+        nonadjacent_base_cost_0 += move_contribution.nonadjacent[0];
+        nonadjacent_base_cost_1 += move_contribution.nonadjacent[1];
+
+        contribution[q][0] = move_contribution.adjacent[0] - move_contribution.nonadjacent[0];
+        contribution[q][1] = move_contribution.adjacent[1] - move_contribution.nonadjacent[1];
+    }
+
+    // every data node collects the contributions of its query nodes, hence there are no concurrent writes
+    std::array<double, 2> nonadjacent_base_cost = {nonadjacent_base_cost_0, nonadjacent_base_cost_1};
+    numa_vector<double> gains(num_data_nodes);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID v = 0; v < num_data_nodes; ++v) {
+        PartitionID p = m_query_graph->get_partition(v);
+        double gain = nonadjacent_base_cost[p];
+        for (NodeID q : m_query_graph->get_adjacent_query_nodes(v)) {
+            gain += contribution[q][p];
+        }
+        gains[v] = gain;
+    }
+
+    return gains;
+}
+
+/**
+ * Calculates the real gain value of every move in a balanced batch, i.e. the cost improvement of the move if all
+ * other moves of the batch are performed as well.
+ *
+ * Since the batch is balanced, the partition sizes do not change and only query nodes adjacent to the batch change
+ * their cost.
+ *
+ * @param batch nodes that are moved to the other partition
+ * @return gain value of batch[i] for every i
+ */
+template<typename CostModel>
+numa_vector<double> batch_refiner<CostModel>::calculate_batch_gain_values(const std::vector<NodeID> &batch) {
+    auto final_degrees = calculate_final_degrees(batch);
+
+    numa_vector<double> gains(batch.size());
+#pragma omp parallel for schedule(dynamic, 64)
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        NodeID v = batch[i];
+
+        // v is in partition 1 - p after the batch was committed
+        PartitionID p = m_query_graph->get_partition(v);
+
+        double gain = 0.0;
+        for (NodeID q : m_query_graph->get_adjacent_query_nodes(v)) {
+            auto degrees = final_degrees[q];
+            gain -= calculate_node_cost(degrees);
+
+            assert(degrees[1 - p] > 0);
+            ++degrees[p];
+            --degrees[1 - p];
+            gain += calculate_node_cost(degrees);
+        }
+        gains[i] = gain;
+    }
+
+    return gains;
+}
+
+/**
+ * Calculates the exact cost improvement if all nodes of a balanced batch are moved to the other partition.
+ *
+ * @param batch
+ * @return
+ */
+template<typename CostModel>
+double batch_refiner<CostModel>::calculate_batch_gain(const std::vector<NodeID> &batch) {
+    auto final_degrees = calculate_final_degrees(batch);
+
+    double gain = 0.0;
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: gain)
+    for (NodeID q = 0; q < m_query_graph->number_of_query_nodes(); ++q) {
+        if (final_degrees[q] != m_degrees[q]) {
+            gain += calculate_node_cost(m_degrees[q]) - calculate_node_cost(final_degrees[q]);
+        }
+    }
+
+    return gain;
+}
+
+/**
+ * Calculates the degrees of every query node after all nodes of the batch were moved to the other partition.
+ *
+ * @param batch
+ * @return
+ */
+template<typename CostModel>
+numa_vector<std::array<NodeID, 2>> batch_refiner<CostModel>::calculate_final_degrees(const std::vector<NodeID> &batch) {
+    numa_vector<std::array<NodeID, 2>> final_degrees(m_degrees);
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        NodeID v = batch[i];
+        PartitionID p = m_query_graph->get_partition(v);
+
+        for (NodeID q : m_query_graph->get_adjacent_query_nodes(v)) {
+#pragma omp atomic
+            --final_degrees[q][p];
+#pragma omp atomic
+            ++final_degrees[q][1 - p];
+        }
+    }
+
+    return final_degrees;
+}
+
+template<typename CostModel>
+double batch_refiner<CostModel>::calculate_node_cost(const std::array<NodeID, 2> &degrees) {
+    assert (degrees[0] <= m_partition_sizes[0] && degrees[1] <= m_partition_sizes[1]);
+    return calculate_query_node_cost<CostModel>(m_partition_sizes, degrees);
+}
+
+template<typename CostModel>
+double batch_refiner<CostModel>::calculate_partition_cost() {
+    return utils::calculate_partition_cost<CostModel>(*m_query_graph);
+}
+
+namespace bathesis {
+    template class batch_refiner<loggap_cost>;
+    template class batch_refiner<log_cost>;
+    template class batch_refiner<mla_cost>;
+    template class batch_refiner<k2tree_cost>;
+}
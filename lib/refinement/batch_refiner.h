@@ -0,0 +1,46 @@
+#ifndef IMPL_BATCH_REFINER_H
+#define IMPL_BATCH_REFINER_H
+
+#include "refiner_interface.h"
+#include "cost_models.h"
+
+namespace bathesis {
+
+    /**
+     * Refiner that moves a whole batch of nodes at once.
+     *
+     * Gain values are computed for all nodes from a snapshot of the partition. The best pairs of nodes are selected
+     * as a batch; then the real gain of each move is re-evaluated given the other moves of the batch that share a
+     * query node with it. Moves that turn out to be negative are dropped before the batch is committed.
+     *
+     * @tparam CostModel estimate of the cost of a query node, see cost_models.h
+     */
+    template<typename CostModel = loggap_cost>
+    class batch_refiner : public refiner_interface {
+        int m_max_validation_rounds;
+
+        std::array<NodeID, 2> m_partition_sizes{0, 0};
+
+        numa_vector<std::array<NodeID, 2>> m_degrees;
+
+        numa_vector<double> calculate_gain_values();
+
+        numa_vector<double> calculate_batch_gain_values(const std::vector<NodeID> &batch);
+
+        numa_vector<std::array<NodeID, 2>> calculate_final_degrees(const std::vector<NodeID> &batch);
+
+        double calculate_batch_gain(const std::vector<NodeID> &batch);
+
+        double calculate_node_cost(const std::array<NodeID, 2> &degrees);
+
+    protected:
+        NodeID perform_refinement_iteration(int nth_iteration, int imbalance);
+
+        double calculate_partition_cost();
+
+    public:
+        batch_refiner(int imbalance = 3, int imbalance_level = 1, int max_validation_rounds = 3);
+    };
+}
+
+#endif // IMPL_BATCH_REFINER_H
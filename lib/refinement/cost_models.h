@@ -0,0 +1,191 @@
+#ifndef IMPL_COST_MODELS_H
+#define IMPL_COST_MODELS_H
+
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#include <data_structure/graph_access.h>
+
+namespace bathesis {
+
+    /*
+     * Cost models estimate the cost of a query node from the sizes of both partitions and the number of neighbors of
+     * the query node in each partition, assuming that its neighbors are spread evenly over the partition. Each model
+     * provides
+     *
+     *     static double cost(NodeID partition_size, NodeID degree);
+     *
+     * with the cost of the neighbors of a query node in one partition. Refiners take the model as template parameter,
+     * hence the estimate is inlined into their gain computations.
+     *
+     * A model is separable if its cost splits into a term that depends on the partition size and a term that only
+     * depends on the degree,
+     *
+     *     cost(s, d) = size_factor(s) * degree_factor(d) + degree_term(d).
+     *
+     * Then the cost of a partition is size_factor(s) times the sum of degree_factor over all query nodes plus a sum
+     * of degree_terms, hence moving a weighted data node only changes the terms of its own query nodes and the two
+     * size factors. Separable models set {@code is_separable} and provide these three functions on doubles; the
+     * refiners of the multilevel algorithms, see {@code weighted_lp_refiner}, require them.
+     */
+
+    /**
+     * Log-gap cost: bits needed to encode the gaps between consecutive neighbors of a query node,
+     * {@code d * (1 + log2(s / (d + 1)))}.
+     */
+    struct loggap_cost {
+        static double cost(NodeID partition_size, NodeID degree) {
+            if (partition_size == 0) { // then, degree == 0 as well
+                return 0.0;
+            }
+            return degree * (1 + std::log2(static_cast<double>(partition_size) / (degree + 1)));
+        }
+
+        static constexpr bool is_separable = true;
+
+        static double size_factor(double partition_size) {
+            return partition_size > 0 ? 1 + std::log2(partition_size) : 0.0;
+        }
+
+        static double degree_factor(double degree) {
+            return degree;
+        }
+
+        static double degree_term(double degree) {
+            return -degree * std::log2(degree + 1);
+        }
+    };
+
+    /**
+     * Log cost: logarithm of the gaps between consecutive neighbors of a query node, {@code d * log2(1 + s / (d + 1))}.
+     * Unlike the log-gap cost, the estimate of a gap is never negative and small gaps are not charged an extra bit.
+     * Not separable, since the partition size and the degree share the logarithm.
+     */
+    struct log_cost {
+        static double cost(NodeID partition_size, NodeID degree) {
+            return degree * std::log2(1 + static_cast<double>(partition_size) / (degree + 1));
+        }
+
+        static constexpr bool is_separable = false;
+    };
+
+    /**
+     * Minimum linear arrangement cost: length of the gaps between consecutive neighbors of a query node,
+     * {@code d * s / (d + 1)}.
+     */
+    struct mla_cost {
+        static double cost(NodeID partition_size, NodeID degree) {
+            return degree * static_cast<double>(partition_size) / (degree + 1);
+        }
+
+        static constexpr bool is_separable = true;
+
+        static double size_factor(double partition_size) {
+            return partition_size;
+        }
+
+        static double degree_factor(double degree) {
+            return degree / (degree + 1);
+        }
+
+        static double degree_term(double degree) {
+            return 0.0;
+        }
+    };
+
+    /**
+     * k2-tree estimate: bits needed to select the neighbors of a query node among the nodes of the partition,
+     * {@code log2(binom(s, d))}, i.e. the entropy of its row in the adjacency matrix block of the partition. Not
+     * separable, since the binomial coefficient couples the partition size and the degree.
+     */
+    struct k2tree_cost {
+        /**
+         * Stirling's approximation of {@code log2(n!)}.
+         *
+         * @param n
+         * @return
+         */
+        static double log_factorial(double n) {
+            if (n <= 1) {
+                return 0.0;
+            }
+            return (1.0 / std::log(2)) * (0.5 * std::log(2 * M_PI * n) + n * std::log(n / M_E));
+        }
+
+        static double log_binom(double n, double k) {
+            return log_factorial(n) - log_factorial(k) - log_factorial(n - k);
+        }
+
+        static double cost(NodeID partition_size, NodeID degree) {
+            if (degree >= partition_size) { // degrees might temporarily exceed the partition size in parallel refiners
+                return 0.0;
+            }
+            return log_binom(partition_size, degree);
+        }
+
+        static constexpr bool is_separable = false;
+    };
+
+    /**
+     * Cost of a query node with the given number of neighbors in each partition.
+     *
+     * @tparam CostModel
+     * @param partition_sizes
+     * @param degrees
+     * @return
+     */
+    template<typename CostModel>
+    inline double calculate_query_node_cost(const std::array<NodeID, 2> &partition_sizes,
+                                            const std::array<NodeID, 2> &degrees) {
+        return CostModel::cost(partition_sizes[0], degrees[0]) + CostModel::cost(partition_sizes[1], degrees[1]);
+    }
+
+    /**
+     * Cost differences of a query node when a single data node is moved out of partition p, for p = 0, 1.
+     */
+    struct move_cost_contribution {
+        std::array<double, 2> adjacent{0.0, 0.0};    // the moved node is a neighbor of the query node
+        std::array<double, 2> nonadjacent{0.0, 0.0}; // the moved node is not a neighbor of the query node
+    };
+
+    /**
+     * Cost differences of a query node with the given number of neighbors in each partition when a single data node
+     * is moved to the other partition. The gain value of a data node in partition p is the sum of
+     * {@code nonadjacent[p]} over all query nodes plus {@code adjacent[p] - nonadjacent[p]} over its query nodes.
+     *
+     * @tparam CostModel
+     * @param partition_sizes
+     * @param degrees
+     * @return
+     */
+    template<typename CostModel>
+    inline move_cost_contribution calculate_move_cost_contribution(const std::array<NodeID, 2> &partition_sizes,
+                                                                   const std::array<NodeID, 2> &degrees) {
+        assert(degrees[0] <= partition_sizes[0] && degrees[1] <= partition_sizes[1]);
+        const std::array<std::array<NodeID, 2>, 2> moved_partition_sizes = {{
+                {{partition_sizes[0] - 1, partition_sizes[1] + 1}},
+                {{partition_sizes[0] + 1, partition_sizes[1] - 1}}
+        }};
+        const double cost = calculate_query_node_cost<CostModel>(partition_sizes, degrees);
+
+        move_cost_contribution contribution;
+        if (degrees[0] > 0) {
+            contribution.adjacent[0] = cost - calculate_query_node_cost<CostModel>(
+                    moved_partition_sizes[0], std::array<NodeID, 2>{degrees[0] - 1, degrees[1] + 1});
+        }
+        if (degrees[1] > 0) {
+            contribution.adjacent[1] = cost - calculate_query_node_cost<CostModel>(
+                    moved_partition_sizes[1], std::array<NodeID, 2>{degrees[0] + 1, degrees[1] - 1});
+        }
+        for (int p = 0; p < 2; ++p) {
+            if (partition_sizes[p] > 0 && degrees[p] < partition_sizes[p]) {
+                contribution.nonadjacent[p] = cost - calculate_query_node_cost<CostModel>(
+                        moved_partition_sizes[p], degrees);
+            }
+        }
+        return contribution;
+    }
+}
+
+#endif // IMPL_COST_MODELS_H
@@ -4,8 +4,13 @@
 
 using namespace bathesis;
 
-fm_refiner::fm_refiner(int imbalance, int imbalance_level)
-    : refiner_interface(imbalance, imbalance_level) {}
+namespace {
+    const NodeID empty = std::numeric_limits<NodeID>().max();
+}
+
+fm_refiner::fm_refiner(int imbalance, int imbalance_level, bool boundary_only)
+    : refiner_interface(imbalance, imbalance_level),
+      m_boundary_only(boundary_only) {}
 
 NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
                                                 int imbalance) {
@@ -15,27 +20,13 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
     auto &query_node_info = node_info.first;
     auto &data_node_info = node_info.second;
 
-    NodeID empty = std::numeric_limits<NodeID>().max();
-    std::array<NodeID, 2> max_gain_nodes{empty, empty};
-    forall_nodes((*m_data_graph), v) if (data_node_info[v].marked) continue;
-
-    PartitionID p = m_data_graph->getPartitionIndex(v);
-    if (max_gain_nodes[p] == empty) {
-        max_gain_nodes[p] = v;
-        continue;
+    if (m_boundary_only) {
+        mark_boundary_candidates(query_node_info, data_node_info);
     }
+    init_degree_classes(data_node_info);
 
-    NodeID max = max_gain_nodes[p];
-
-    if (data_node_info[max].gain + data_node_info[max].gain2 <
-        data_node_info[v].gain + data_node_info[v].gain2) {
-        max_gain_nodes[p] = v;
-    }
-    endfor
-
-        // selected nodes in the order they were selected
-        std::vector<NodeID>
-            S;
+    // selected nodes in the order they were selected
+    std::vector<NodeID> S;
 
     // selection strategy: if the imbalance constraint allows it, choose node
     // with the biggest gain value; if the balance constraint is too tight,
@@ -50,14 +41,14 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
                      static_cast<long>(m_partition_sizes[1])) /
             static_cast<double>((m_partition_sizes[0] + m_partition_sizes[1]));
 
-        NodeID m0 = max_gain_nodes[0];
-        NodeID m1 = max_gain_nodes[1];
-        if (max_gain_nodes[0] != empty && max_gain_nodes[1] != empty) {
+        std::array<double, 2> max_gains{0.0, 0.0};
+        NodeID m0 = find_max_gain_node(0, max_gains[0]);
+        NodeID m1 = find_max_gain_node(1, max_gains[1]);
+        if (m0 != empty && m1 != empty) {
             if (current_imbalance * 100 <
                 imbalance) {  // balance constraint allows us to choose from any
                               // queue
-                if (data_node_info[m0].gain + data_node_info[m0].gain2 <
-                    data_node_info[m1].gain + data_node_info[m1].gain2) {
+                if (max_gains[0] < max_gains[1]) {
                     v = m1;
                 } else {
                     v = m0;
@@ -69,11 +60,11 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
                     v = m0;
                 }
             }
-        } else if (max_gain_nodes[0] != empty &&
+        } else if (m0 != empty &&
                    (current_imbalance * 100 < imbalance ||
                     m_partition_sizes[1] < m_partition_sizes[0])) {
             v = m0;
-        } else if (max_gain_nodes[1] != empty &&
+        } else if (m1 != empty &&
                    (current_imbalance * 100 < imbalance ||
                     m_partition_sizes[0] < m_partition_sizes[1])) {
             v = m1;
@@ -83,38 +74,8 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
 
         S.push_back(v);
         update_gain_values(query_node_info, data_node_info, v);
-
-        max_gain_nodes[0] = empty;
-        max_gain_nodes[1] = empty;
-        forall_nodes((*m_data_graph), v) if (data_node_info[v].marked) continue;
-
-        PartitionID p = m_data_graph->getPartitionIndex(v);
-        if (max_gain_nodes[p] == empty) {
-            max_gain_nodes[p] = v;
-            continue;
-        }
-
-        NodeID max = max_gain_nodes[p];
-
-        if (data_node_info[max].gain + data_node_info[max].gain2 <
-            data_node_info[v].gain + data_node_info[v].gain2) {
-            max_gain_nodes[p] = v;
-        }
-        endfor
-
-            // TODO remove
-            if (S.size() % 1000 == 0) {
-            std::cout << "nth_node_calculated = " << S.size()
-                      << "; processed edges so far: "
-                      << m_data_graph->get_first_invalid_edge(
-                             static_cast<NodeID>(S.size() - 1))
-                      << std::endl;
-        }
     }
 
-    // TODO remove
-    std::cout << "S filled" << std::endl;
-
     // find maximal prefix sum of S
     std::size_t max_k = 0;  // swap 0..max_k for maximal gain
     auto max_value =
@@ -136,10 +97,10 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
         // perform swaps
         for (std::size_t i = 0; i <= max_k; ++i) {
             NodeID u = S[i];
-            PartitionID p = m_data_graph->getPartitionIndex(u);
-            bool is_boundary = utils::is_boundary_node(*m_data_graph, u);
+            PartitionID p = m_query_graph->get_partition(u);
+            bool is_boundary = m_query_graph->is_boundary_node(u);
 
-            m_data_graph->setPartitionIndex(u, 1 - p);
+            m_query_graph->set_partition(u, 1 - p);
             m_reporter->refinement_move_node(
                 *m_query_graph, u, p, data_node_info[u].gain,
                 data_node_info[u].gain - data_node_info[u].gain2,
@@ -157,22 +118,22 @@ NodeID fm_refiner::perform_refinement_iteration(int nth_iteration,
     return 0;
 }
 
-std::pair<std::vector<query_node_info>, std::vector<data_node_info>>
+std::pair<numa_vector<query_node_info>, numa_vector<data_node_info>>
 fm_refiner::calculate_gain_values() {
-    std::vector<query_node_info> query_node_info(
+    numa_vector<query_node_info> query_node_info(
         m_query_graph->number_of_query_nodes());
-    std::vector<data_node_info> data_node_info(m_data_graph->number_of_nodes());
+    numa_vector<data_node_info> data_node_info(m_query_graph->number_of_data_nodes());
 
-    m_nonadjacent_base_cost[0] = 0.0;
-    m_nonadjacent_base_cost[1] = 0.0;
     m_partition_edges[0] = 0;
     m_partition_edges[1] = 0;
 
-    forall_nodes((*m_data_graph), v) data_node_info[v].node = v;
-    data_node_info[v].gain = 0.0;
-    data_node_info[v].gain2 = 0.0;
-    data_node_info[v].marked = false;
-    endfor
+    for (NodeID v = 0; v < data_node_info.size(); ++v) {
+        data_node_info[v].node = v;
+        data_node_info[v].gain = 0.0;
+        data_node_info[v].gain2 = 0.0;
+        data_node_info[v].marked = false;
+        data_node_info[v].candidate = true;
+    }
 
         for (NodeID q = 0; q < m_query_graph->number_of_query_nodes(); ++q) {
         query_node_info[q].node = q;
@@ -183,7 +144,6 @@ fm_refiner::calculate_gain_values() {
 
         // convenience references to make the code look cleaner
         auto &degrees = query_node_info[q].degrees;
-        auto &cost = query_node_info[q].cost;
         auto &adjacent_node_contribution =
             query_node_info[q].adjacent_node_contribution;
 
@@ -210,10 +170,8 @@ fm_refiner::calculate_gain_values() {
                 (degrees[1] - 1) * utils::log(degrees[1]);
         }
 
-        for (EdgeID e = m_query_graph->get_first_edge(q);
-             e < m_query_graph->get_first_invalid_edge(q); ++e) {
-            NodeID v = m_query_graph->get_edge_target(e);
-            PartitionID p = m_data_graph->getPartitionIndex(v);
+        for (NodeID v : m_query_graph->get_adjacent_data_nodes(q)) {
+            PartitionID p = m_query_graph->get_partition(v);
 
             data_node_info[v].gain += adjacent_node_contribution[p];
 
@@ -221,63 +179,159 @@ fm_refiner::calculate_gain_values() {
         }
     }
 
-    forall_nodes((*m_data_graph), v) std::size_t adj =
-        m_query_graph->get_adjacent_query_nodes(v).size();
+    return {query_node_info, data_node_info};
+}
 
-    if (m_data_graph->getPartitionIndex(v) == 0) {
-        assert(m_partition_edges[0] >= adj);
-        assert(m_partition_sizes[0] > 0);
+/**
+ * Groups the unmarked data nodes of each partition by their number of adjacent
+ * query nodes and builds one heap per group.
+ *
+ * @param data_node_info
+ */
+void fm_refiner::init_degree_classes(
+    numa_vector<data_node_info> &data_node_info) {
+    const NodeID n = m_query_graph->number_of_data_nodes();
+
+    std::vector<std::size_t> degrees(n);
+    std::size_t max_degree = 0;
+#pragma omp parallel for reduction(max : max_degree)
+    for (NodeID v = 0; v < n; ++v) {
+        degrees[v] = m_query_graph->get_number_of_adjacent_query_nodes(v);
+        max_degree = std::max(max_degree, degrees[v]);
+    }
 
-        data_node_info[v].gain2 = 0.0;
-        data_node_info[v].gain2 +=
-            m_partition_edges[0] * (utils::log(m_partition_sizes[0]) + 1);
-        if (m_partition_sizes[1] > 0) {
-            data_node_info[v].gain2 +=
-                m_partition_edges[1] * (utils::log(m_partition_sizes[1]) + 1);
-        }
-        if (m_partition_sizes[0] > 1) {
-            data_node_info[v].gain2 -=
-                (m_partition_edges[0] - adj) *
-                (utils::log(m_partition_sizes[0] - 1) + 1);
+    for (PartitionID p = 0; p < 2; ++p) {
+        auto &classes = m_degree_classes[p];
+        classes.clear();
+
+        std::vector<std::size_t> class_of_degree(max_degree + 1, empty);
+        for (NodeID v = 0; v < n; ++v) {
+            if (m_query_graph->get_partition(v) != p) continue;
+
+            std::size_t &id = class_of_degree[degrees[v]];
+            if (id == empty) {
+                id = classes.size();
+                classes.emplace_back();
+                classes.back().degree = degrees[v];
+            }
+
+            data_node_info[v].degree_class = id;
+            data_node_info[v].degree_class_position =
+                static_cast<NodeID>(classes[id].nodes.size());
+            classes[id].nodes.push_back(v);
         }
-        data_node_info[v].gain2 -= (m_partition_edges[1] + adj) *
-                                   (utils::log(m_partition_sizes[1] + 1) + 1);
-    } else {
-        assert(m_partition_edges[1] >= adj);
-        assert(m_partition_sizes[1] > 0);
 
-        data_node_info[v].gain2 = 0.0;
-        if (m_partition_sizes[0] > 0) {
-            data_node_info[v].gain2 +=
-                m_partition_edges[0] * (utils::log(m_partition_sizes[0]) + 1);
+        for (auto &degree_class : classes) {
+            std::vector<std::pair<double, NodeID>> entries;
+            entries.reserve(degree_class.nodes.size());
+            for (NodeID i = 0; i < degree_class.nodes.size(); ++i) {
+                auto &info = data_node_info[degree_class.nodes[i]];
+                if (info.candidate) {
+                    entries.emplace_back(info.gain, i);
+                }
+            }
+
+            degree_class.queue.reset(degree_class.nodes.size());
+            degree_class.queue.build(std::move(entries));
         }
-        data_node_info[v].gain2 +=
-            m_partition_edges[1] * (utils::log(m_partition_sizes[1]) + 1);
-        data_node_info[v].gain2 -= (m_partition_edges[0] + adj) *
-                                   (utils::log(m_partition_sizes[0] + 1) + 1);
-        if (m_partition_sizes[1] > 1) {
-            data_node_info[v].gain2 -=
-                (m_partition_edges[1] - adj) *
-                (utils::log(m_partition_sizes[1] - 1) + 1);
+    }
+}
+
+/**
+ * Restricts the move candidates to the data nodes that are adjacent to a query
+ * node with neighbors in both partitions.
+ *
+ * @param query_node_info
+ * @param data_node_info
+ */
+void fm_refiner::mark_boundary_candidates(
+    numa_vector<query_node_info> &query_node_info,
+    numa_vector<data_node_info> &data_node_info) {
+    const NodeID n = m_query_graph->number_of_data_nodes();
+
+#pragma omp parallel for schedule(static)
+    for (NodeID v = 0; v < n; ++v) {
+        data_node_info[v].candidate = false;
+    }
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID q = 0; q < m_query_graph->number_of_query_nodes(); ++q) {
+        auto &degrees = query_node_info[q].degrees;
+        if (degrees[0] == 0 || degrees[1] == 0) continue;
+
+        for (NodeID v : m_query_graph->get_adjacent_data_nodes(q)) {
+#pragma omp atomic write
+            data_node_info[v].candidate = true;
         }
     }
+}
+
+/**
+ * Makes an unmarked node a move candidate during a pass. Since the gains of
+ * other nodes are not maintained, its gain is calculated from scratch.
+ *
+ * @param query_node_info
+ * @param data_node_info
+ * @param node
+ */
+void fm_refiner::add_candidate(numa_vector<query_node_info> &query_node_info,
+                               numa_vector<data_node_info> &data_node_info,
+                               NodeID node) {
+    auto &info = data_node_info[node];
+    assert(!info.marked && !info.candidate);
+
+    PartitionID p = m_query_graph->get_partition(node);
+    info.candidate = true;
+    info.gain = 0.0;
+    for (NodeID q : m_query_graph->get_adjacent_query_nodes(node)) {
+        info.gain += query_node_info[q].adjacent_node_contribution[p];
+    }
+
+    m_degree_classes[p][info.degree_class].queue.insert(
+        info.degree_class_position, info.gain);
+}
 
-    assert(!std::isnan(data_node_info[v].gain2));
-    endfor
+/**
+ * Finds the unmarked node of the given partition with the biggest total gain.
+ * Only the top of each degree class has to be considered, since all nodes of a
+ * class have the same gain on the nonadjacent query nodes.
+ *
+ * @param partition
+ * @param max_gain set to the total gain of the returned node
+ * @return the node or {@code empty} if all nodes of the partition are marked
+ */
+NodeID fm_refiner::find_max_gain_node(PartitionID partition,
+                                      double &max_gain) {
+    NodeID max_gain_node = empty;
+
+    for (auto &degree_class : m_degree_classes[partition]) {
+        if (degree_class.queue.empty()) continue;
+
+        double gain = degree_class.queue.top_key() +
+                      calculate_nonadjacent_gain(partition, degree_class.degree);
+        if (max_gain_node == empty || max_gain < gain) {
+            max_gain = gain;
+            max_gain_node = degree_class.nodes[degree_class.queue.top()];
+        }
+    }
 
-        return {query_node_info, data_node_info};
+    return max_gain_node;
 }
 
 void fm_refiner::update_gain_values(
-    std::vector<query_node_info> &query_node_info,
-    std::vector<data_node_info> &data_node_info, NodeID node) {
+    numa_vector<query_node_info> &query_node_info,
+    numa_vector<data_node_info> &data_node_info, NodeID node) {
     assert(!data_node_info[node].marked);
 
-    auto partition = m_data_graph->getPartitionIndex(node);
+    auto partition = m_query_graph->get_partition(node);
+    auto adjacent_query_nodes = m_query_graph->get_adjacent_query_nodes(node);
+
     data_node_info[node].marked = true;
+    data_node_info[node].gain2 =
+        calculate_nonadjacent_gain(partition, adjacent_query_nodes.size());
     data_node_info[node].gain += data_node_info[node].gain2;
-
-    auto adjacent_query_nodes = m_query_graph->get_adjacent_query_nodes(node);
+    m_degree_classes[partition][data_node_info[node].degree_class]
+        .queue.remove(data_node_info[node].degree_class_position);
 
     assert(m_partition_sizes[partition] > 0);
     --m_partition_sizes[partition];
@@ -287,7 +341,8 @@ void fm_refiner::update_gain_values(
     m_partition_edges[partition] -= adjacent_query_nodes.size();
     m_partition_edges[1 - partition] += adjacent_query_nodes.size();
 
-    // O(MaxDegree(QG)^2)
+    // O(MaxDegree(QG)^2 log n); the gain of the nonadjacent query nodes is
+    // evaluated per degree class when selecting the next node
     for (NodeID q : adjacent_query_nodes) {
         auto &degrees = query_node_info[q].degrees;
         auto &adjacent_node_contribution =
@@ -322,65 +377,67 @@ void fm_refiner::update_gain_values(
                 (degrees[1] - 1) * utils::log(degrees[1]);
         }
 
-        for (EdgeID edge = m_query_graph->get_first_edge(q);
-             edge < m_query_graph->get_first_invalid_edge(q); ++edge) {
-            NodeID v = m_query_graph->get_edge_target(edge);
-            PartitionID p = m_data_graph->getPartitionIndex(v);
+        for (NodeID v : m_query_graph->get_adjacent_data_nodes(q)) {
+            PartitionID p = m_query_graph->get_partition(v);
 
-            if (!data_node_info[v].marked) {
+            if (!data_node_info[v].marked && data_node_info[v].candidate &&
+                adjacent_node_contribution[p] !=
+                    new_adjacent_node_contribution[p]) {
                 data_node_info[v].gain -= adjacent_node_contribution[p];
                 data_node_info[v].gain += new_adjacent_node_contribution[p];
+                m_degree_classes[p][data_node_info[v].degree_class]
+                    .queue.change_key(data_node_info[v].degree_class_position,
+                                      data_node_info[v].gain);
             }
         }
 
         adjacent_node_contribution[0] = new_adjacent_node_contribution[0];
         adjacent_node_contribution[1] = new_adjacent_node_contribution[1];
+
+        // q just got its first neighbor in the other partition
+        if (m_boundary_only && degrees[1 - partition] == 1 &&
+            degrees[partition] > 0) {
+            for (NodeID v : m_query_graph->get_adjacent_data_nodes(q)) {
+                if (!data_node_info[v].marked &&
+                    !data_node_info[v].candidate) {
+                    add_candidate(query_node_info, data_node_info, v);
+                }
+            }
+        }
     }
+}
 
-    double nonadjacent_cost = 0.0;
-    if (m_partition_sizes[0] > 0) {
-        nonadjacent_cost +=
-            m_partition_edges[0] * (utils::log(m_partition_sizes[0]) + 1);
+/**
+ * Calculates the change of cost on the nonadjacent query nodes if a node with
+ * the given number of adjacent query nodes is moved out of the given partition.
+ *
+ * @param partition
+ * @param number_of_adjacent_query_nodes
+ * @return
+ */
+double fm_refiner::calculate_nonadjacent_gain(
+    PartitionID partition, std::size_t number_of_adjacent_query_nodes) {
+    const PartitionID from = partition;
+    const PartitionID to = 1 - partition;
+    const auto adj = number_of_adjacent_query_nodes;
+
+    assert(m_partition_edges[from] >= adj);
+    assert(m_partition_sizes[from] > 0);
+
+    double gain = m_partition_edges[from] *
+                  (utils::log(m_partition_sizes[from]) + 1);
+    if (m_partition_sizes[to] > 0) {
+        gain += m_partition_edges[to] * (utils::log(m_partition_sizes[to]) + 1);
     }
-    if (m_partition_sizes[1] > 0) {
-        nonadjacent_cost +=
-            m_partition_edges[1] * (utils::log(m_partition_sizes[1]) + 1);
+    if (m_partition_sizes[from] > 1) {
+        gain -= (m_partition_edges[from] - adj) *
+                (utils::log(m_partition_sizes[from] - 1) + 1);
     }
+    gain -= (m_partition_edges[to] + adj) *
+            (utils::log(m_partition_sizes[to] + 1) + 1);
 
-// O(|V|)
-#pragma omp parallel for
-    for (NodeID v = 0; v < m_data_graph->number_of_nodes(); ++v) {
-        if (data_node_info[v].marked) continue;
-
-        auto p = m_data_graph->getPartitionIndex(v);
-        auto number_of_adjacent_query_nodes =
-            m_query_graph->get_number_of_adjacent_query_nodes(v);  // O(level)
-
-        assert(m_partition_edges[p] >= number_of_adjacent_query_nodes);
-        assert(m_partition_sizes[p] > 0);
-
-        data_node_info[v].gain2 = nonadjacent_cost;
-
-        if (m_data_graph->getPartitionIndex(v) == 0) {
-            if (m_partition_sizes[0] > 1) {
-                data_node_info[v].gain2 -=
-                    (m_partition_edges[0] - number_of_adjacent_query_nodes) *
-                    (utils::log(m_partition_sizes[0] - 1) + 1);
-            }
-            data_node_info[v].gain2 -=
-                (m_partition_edges[1] + number_of_adjacent_query_nodes) *
-                (utils::log(m_partition_sizes[1] + 1) + 1);
-        } else {
-            data_node_info[v].gain2 -=
-                (m_partition_edges[0] + number_of_adjacent_query_nodes) *
-                (utils::log(m_partition_sizes[0] + 1) + 1);
-            if (m_partition_sizes[1] > 1) {
-                data_node_info[v].gain2 -=
-                    (m_partition_edges[1] - number_of_adjacent_query_nodes) *
-                    (utils::log(m_partition_sizes[1] - 1) + 1);
-            }
-        }
-    }
+    assert(!std::isnan(gain));
+    return gain;
 }
 
 double fm_refiner::calculate_node_cost(const std::array<NodeID, 2> &degrees) {
@@ -390,18 +447,7 @@ double fm_refiner::calculate_node_cost(const std::array<NodeID, 2> &degrees) {
 double fm_refiner::calculate_node_cost(
     const std::array<NodeID, 2> &partition_sizes,
     const std::array<NodeID, 2> &degrees) {
-    auto cost = 0.0;
-
-    for (std::size_t i = 0; i < 2; ++i) {
-        assert(degrees[i] <= partition_sizes[i]);
-
-        // if partition_sizes[i] == 0, then degrees[i] == 0 and hence cost += 0
-        if (partition_sizes[i] > 0) {
-            cost += degrees[i] *
-                    utils::log(static_cast<double>(partition_sizes[i]) /
-                               (degrees[i] + 1));
-        }
-    }
-
-    return cost;
+    assert(degrees[0] <= partition_sizes[0] &&
+           degrees[1] <= partition_sizes[1]);
+    return calculate_query_node_cost<loggap_cost>(partition_sizes, degrees);
 }
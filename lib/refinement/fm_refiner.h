@@ -2,7 +2,8 @@
 #define IMPL_FM_REFINER_H
 
 #include "refiner_interface.h"
-#include "../data-structure/max_node_heap.h"
+#include "cost_models.h"
+#include "../data-structure/addressable_heap.h"
 
 namespace bathesis {
     struct query_node_info {
@@ -14,24 +15,63 @@ namespace bathesis {
 
     struct data_node_info {
         NodeID node;
-        double gain = 0.0;
-        double gain2 = 0.0;
+        double gain = 0.0;  // adjacent query nodes only, until the node is marked
+        double gain2 = 0.0; // nonadjacent query nodes, set when the node is marked
         bool marked = false;
+        bool candidate = true;
+        std::size_t degree_class = 0;
+        NodeID degree_class_position = 0;
     };
 
+    /**
+     * The gain of a node on the nonadjacent query nodes only depends on its partition and on its number of adjacent
+     * query nodes. Unmarked nodes that agree on those share a degree class and are ordered by their gain on the
+     * adjacent query nodes.
+     */
+    struct degree_class {
+        std::size_t degree;
+        std::vector<NodeID> nodes;
+        max_heap<double> queue; // elements are positions in nodes
+    };
+
+    /**
+     * FM refiner on the bipartite objective.
+     *
+     * In boundary-only mode, only nodes adjacent to a query node with neighbors in both partitions are move
+     * candidates; other nodes only become candidates once one of their query nodes gets a neighbor in the other
+     * partition during a pass. Gains are only maintained for candidates.
+     *
+     * The gain computation relies on the log-gap cost splitting into a term that only depends on the number of edges
+     * in each partition and a term that only depends on the degrees of the query nodes, hence this refiner is
+     * specific to {@code loggap_cost}.
+     */
     class fm_refiner : public refiner_interface {
         int m_max_refinement_iterations;
 
+        bool m_boundary_only;
+
         std::array<NodeID, 2> m_partition_sizes{0, 0};
 
         std::array<EdgeID, 2> m_partition_edges{0, 0};
 
-        std::pair<std::vector<query_node_info>, std::vector<data_node_info>> calculate_gain_values();
+        std::array<std::vector<degree_class>, 2> m_degree_classes;
+
+        std::pair<numa_vector<query_node_info>, numa_vector<data_node_info>> calculate_gain_values();
+
+        void init_degree_classes(numa_vector<data_node_info> &data_node_info);
+
+        void mark_boundary_candidates(numa_vector<query_node_info> &query_node_info,
+                                      numa_vector<data_node_info> &data_node_info);
+
+        void add_candidate(numa_vector<query_node_info> &query_node_info, numa_vector<data_node_info> &data_node_info,
+                           NodeID node);
+
+        NodeID find_max_gain_node(PartitionID partition, double &max_gain);
 
-        std::array<double, 2> m_nonadjacent_base_cost{0.0, 0.0};
+        void update_gain_values(numa_vector<query_node_info> &query_node_info,
+                                numa_vector<data_node_info> &data_node_info, NodeID node);
 
-        void update_gain_values(std::vector<query_node_info> &query_node_info,
-                                std::vector<data_node_info> &data_node_info, NodeID node);
+        double calculate_nonadjacent_gain(PartitionID partition, std::size_t number_of_adjacent_query_nodes);
 
         double calculate_node_cost(const std::array<NodeID, 2> &degrees);
 
@@ -41,7 +81,7 @@ namespace bathesis {
         NodeID perform_refinement_iteration(int nth_iteration, int imbalance);
 
     public:
-        fm_refiner(int imbalance = 3, int imbalance_level = 1);
+        fm_refiner(int imbalance = 3, int imbalance_level = 1, bool boundary_only = false);
     };
 }
 
@@ -8,35 +8,38 @@ fm_refiner_quadtree::fm_refiner_quadtree(int imbalance, int imbalance_level)
 }
 
 NodeID fm_refiner_quadtree::perform_refinement_iteration(int nth_iteration, int imbalance) {
+    m_data_graph = &m_query_graph->data_graph();
     auto node_info = init_partition_info();
 
-    std::array<maxNodeHeap, 2> queues;
+    // group the nodes by gain classes; their number is usually much smaller than the number of nodes
+    m_gain_classes.clear();
+    m_gain_class_ids[0].clear();
+    m_gain_class_ids[1].clear();
     forall_nodes((*m_data_graph), v)
-            PartitionID p = m_data_graph->getPartitionIndex(v);
-            queues[p].insert(v, node_info[v].gain);
+            insert_into_gain_class(v, node_info);
     endfor
 
     // selected nodes in the order they were selected
     std::vector<NodeID> S;
 
-    // selection strategy: choose queues alternatively
-    auto limit = std::min(queues[0].size(), queues[1].size());
-    auto old_partition = utils::get_partition(*m_data_graph);
+    // selection strategy: choose partitions alternatively
+    auto limit = std::min(m_partition_sizes[0], m_partition_sizes[1]);
+    auto old_partition = utils::get_partition(*m_query_graph);
     for (std::size_t k = 0; k < 2 * limit; ++k) {
-        PartitionID p = static_cast<PartitionID>(k % 2); // select queues alternatively
-        NodeID v = queues[p].deleteMax();
+        PartitionID p = static_cast<PartitionID>(k % 2); // select partitions alternatively
 
-        // moves v to the other partition and updates the gain value of all unmarked nodes in node_info
+        // every move changes the gain values of all classes, but only nodes adjacent to the moved node change
+        // their class
+        double gain = 0.0;
+        std::size_t c = find_max_gain_class(p, gain);
+        NodeID v = m_gain_classes[c].nodes.back();
+        node_info[v].gain = gain;
+
+        // moves v to the other partition and updates the gain classes of its neighbors
         move_and_update(v, node_info); // also marks v
         S.push_back(v);
-
-        // update keys in the priority queues
-        for (NodeID u = 0; u < m_data_graph->number_of_nodes(); ++u) {
-            if (node_info[u].marked) continue;
-            queues[m_data_graph->getPartitionIndex(u)].changeKey(u, node_info[u].gain);
-        }
     }
-    utils::set_partition(*m_data_graph, old_partition); // restore initial partition
+    utils::set_partition(*m_query_graph, old_partition); // restore initial partition
 
     // find maximal prefix sum of S
     std::size_t max_k = 0; // swap 0..max_k for maximal gain
@@ -58,10 +61,10 @@ NodeID fm_refiner_quadtree::perform_refinement_iteration(int nth_iteration, int
         // perform swaps
         for (std::size_t i = 0; i <= max_k; ++i) {
             NodeID u = S[i];
-            PartitionID p = m_data_graph->getPartitionIndex(u);
-            bool is_boundary = utils::is_boundary_node(*m_data_graph, u);
+            PartitionID p = m_query_graph->get_partition(u);
+            bool is_boundary = m_query_graph->is_boundary_node(u);
 
-            m_data_graph->setPartitionIndex(u, 1 - p);
+            m_query_graph->set_partition(u, 1 - p);
             m_reporter->refinement_move_node(*m_query_graph, u, p, node_info[u].gain, 0, 0, is_boundary);
         }
 
@@ -80,9 +83,10 @@ NodeID fm_refiner_quadtree::perform_refinement_iteration(int nth_iteration, int
 }
 
 void fm_refiner_quadtree::move_and_update(NodeID node, std::vector<node_info> &nodes) {
-    PartitionID old_partition = m_data_graph->getPartitionIndex(node);
+    PartitionID old_partition = m_query_graph->get_partition(node);
     PartitionID new_partition = 1 - old_partition;
-    m_data_graph->setPartitionIndex(node, new_partition);
+    remove_from_gain_class(node, nodes);
+    m_query_graph->set_partition(node, new_partition);
     nodes[node].marked = true;
 
     // update m_partition_sizes
@@ -92,7 +96,11 @@ void fm_refiner_quadtree::move_and_update(NodeID node, std::vector<node_info> &n
     // update m_num_edges_from_to
     for (EdgeID e = m_data_graph->get_first_edge(node); e < m_data_graph->get_first_invalid_edge(node); ++e) {
         NodeID u = m_data_graph->getEdgeTarget(e);
-        PartitionID p = m_data_graph->getPartitionIndex(u);
+        PartitionID p = m_query_graph->get_partition(u);
+
+        if (!nodes[u].marked) {
+            remove_from_gain_class(u, nodes);
+        }
 
         --m_num_edges_from_to[old_partition][p];
         ++m_num_edges_from_to[new_partition][p];
@@ -100,63 +108,118 @@ void fm_refiner_quadtree::move_and_update(NodeID node, std::vector<node_info> &n
         ++m_num_edges_from_to[p][new_partition]; // assuming m_data_graph is undirected
         --nodes[u].num_edges_to[old_partition]; // assuming m_data_graph is undirected
         ++nodes[u].num_edges_to[new_partition]; // assuming m_data_graph is undirected
+
+        if (!nodes[u].marked) {
+            insert_into_gain_class(u, nodes);
+        }
+    }
+}
+
+void fm_refiner_quadtree::insert_into_gain_class(NodeID node, std::vector<node_info> &nodes) {
+    PartitionID p = m_query_graph->get_partition(node);
+    auto &num_edges_to = nodes[node].num_edges_to;
+    std::uint64_t key = (static_cast<std::uint64_t>(num_edges_to[0]) << 32) | num_edges_to[1];
+
+    auto it = m_gain_class_ids[p].find(key);
+    if (it == m_gain_class_ids[p].end()) {
+        it = m_gain_class_ids[p].emplace(key, m_gain_classes.size()).first;
+        m_gain_classes.push_back(gain_class{p, num_edges_to, {}});
     }
 
-    update_gain_values(nodes);
+    auto &members = m_gain_classes[it->second].nodes;
+    nodes[node].gain_class = it->second;
+    nodes[node].gain_class_position = members.size();
+    members.push_back(node);
+}
+
+void fm_refiner_quadtree::remove_from_gain_class(NodeID node, std::vector<node_info> &nodes) {
+    auto &members = m_gain_classes[nodes[node].gain_class].nodes;
+    std::size_t position = nodes[node].gain_class_position;
+    assert (members[position] == node);
+
+    members[position] = members.back();
+    nodes[members[position]].gain_class_position = position;
+    members.pop_back();
 }
 
 /**
- * Updates the node_info::gain member after other members of the data structure were changed (or m_partition_sizes or
- * m_num_edges_from_to).
+ * Finds the nonempty gain class of the given partition with the highest gain value.
  *
- * @param nodes
+ * @param partition
+ * @param max_gain output: gain value of the class
+ * @return
  */
-void fm_refiner_quadtree::update_gain_values(std::vector<node_info> &nodes) {
-    double old_cost = evaluate_cost_function();
+std::size_t fm_refiner_quadtree::find_max_gain_class(PartitionID partition, double &max_gain) {
+    std::size_t max_class = m_gain_classes.size();
+    max_gain = std::numeric_limits<double>().lowest();
+
+    for (auto &entry : m_gain_class_ids[partition]) {
+        auto &c = m_gain_classes[entry.second];
+        if (c.nodes.empty()) {
+            continue;
+        }
 
-    for (NodeID v = 0; v < m_data_graph->number_of_nodes(); ++v) {
-        if (nodes[v].marked) continue;
-
-        PartitionID old_p = m_data_graph->getPartitionIndex(v);
-        PartitionID new_p = 1 - old_p;
-
-        assert (m_partition_sizes[old_p] > 0);
-        --m_partition_sizes[old_p];
-        ++m_partition_sizes[new_p];
-
-        // this node
-        assert (m_num_edges_from_to[old_p][old_p] >= nodes[v].num_edges_to[old_p]);
-        assert (m_num_edges_from_to[old_p][new_p] >= nodes[v].num_edges_to[new_p]);
-        m_num_edges_from_to[old_p][old_p] -= nodes[v].num_edges_to[old_p];
-        m_num_edges_from_to[old_p][new_p] -= nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[new_p][old_p] += nodes[v].num_edges_to[old_p];
-        m_num_edges_from_to[new_p][new_p] += nodes[v].num_edges_to[new_p];
-
-        // this node's neighbors -- assuming that m_data_graph is undirected
-        assert (m_num_edges_from_to[old_p][old_p] >= nodes[v].num_edges_to[old_p]);
-        m_num_edges_from_to[old_p][old_p] -= nodes[v].num_edges_to[old_p];
-        m_num_edges_from_to[old_p][new_p] += nodes[v].num_edges_to[old_p];
-        assert (m_num_edges_from_to[new_p][old_p] >= nodes[v].num_edges_to[new_p]);
-        m_num_edges_from_to[new_p][old_p] -= nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[new_p][new_p] += nodes[v].num_edges_to[new_p];
-
-        double new_cost = evaluate_cost_function();
-
-        m_num_edges_from_to[new_p][new_p] -= nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[new_p][old_p] -= nodes[v].num_edges_to[old_p];
-        m_num_edges_from_to[old_p][new_p] += nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[old_p][old_p] += nodes[v].num_edges_to[old_p];
-
-        m_num_edges_from_to[new_p][new_p] -= nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[new_p][old_p] += nodes[v].num_edges_to[new_p];
-        m_num_edges_from_to[old_p][new_p] -= nodes[v].num_edges_to[old_p];
-        m_num_edges_from_to[old_p][old_p] += nodes[v].num_edges_to[old_p];
-
-        --m_partition_sizes[new_p];
-        ++m_partition_sizes[old_p];
-
-        nodes[v].gain = old_cost - new_cost;
+        double gain = calculate_gain(partition, c.num_edges_to);
+        if (gain > max_gain || (gain == max_gain && entry.second < max_class)) {
+            max_gain = gain;
+            max_class = entry.second;
+        }
     }
+
+    assert (max_class < m_gain_classes.size());
+    return max_class;
+}
+
+/**
+ * Calculates the gain value of a node in the given partition with the given number of edges to each partition, using
+ * the current values of m_partition_sizes and m_num_edges_from_to.
+ *
+ * @param partition
+ * @param num_edges_to
+ * @return
+ */
+double fm_refiner_quadtree::calculate_gain(PartitionID partition, const std::array<NodeID, 2> &num_edges_to) {
+    double old_cost = evaluate_cost_function();
+
+    PartitionID old_p = partition;
+    PartitionID new_p = 1 - old_p;
+
+    assert (m_partition_sizes[old_p] > 0);
+    --m_partition_sizes[old_p];
+    ++m_partition_sizes[new_p];
+
+    // this node
+    assert (m_num_edges_from_to[old_p][old_p] >= num_edges_to[old_p]);
+    assert (m_num_edges_from_to[old_p][new_p] >= num_edges_to[new_p]);
+    m_num_edges_from_to[old_p][old_p] -= num_edges_to[old_p];
+    m_num_edges_from_to[old_p][new_p] -= num_edges_to[new_p];
+    m_num_edges_from_to[new_p][old_p] += num_edges_to[old_p];
+    m_num_edges_from_to[new_p][new_p] += num_edges_to[new_p];
+
+    // this node's neighbors -- assuming that m_data_graph is undirected
+    assert (m_num_edges_from_to[old_p][old_p] >= num_edges_to[old_p]);
+    m_num_edges_from_to[old_p][old_p] -= num_edges_to[old_p];
+    m_num_edges_from_to[old_p][new_p] += num_edges_to[old_p];
+    assert (m_num_edges_from_to[new_p][old_p] >= num_edges_to[new_p]);
+    m_num_edges_from_to[new_p][old_p] -= num_edges_to[new_p];
+    m_num_edges_from_to[new_p][new_p] += num_edges_to[new_p];
+
+    double new_cost = evaluate_cost_function();
+
+    m_num_edges_from_to[new_p][new_p] -= num_edges_to[new_p];
+    m_num_edges_from_to[new_p][old_p] -= num_edges_to[old_p];
+    m_num_edges_from_to[old_p][new_p] += num_edges_to[new_p];
+    m_num_edges_from_to[old_p][old_p] += num_edges_to[old_p];
+
+    m_num_edges_from_to[new_p][new_p] -= num_edges_to[new_p];
+    m_num_edges_from_to[new_p][old_p] += num_edges_to[new_p];
+    m_num_edges_from_to[old_p][new_p] -= num_edges_to[old_p];
+    m_num_edges_from_to[old_p][old_p] += num_edges_to[old_p];
+
+    --m_partition_sizes[new_p];
+    ++m_partition_sizes[old_p];
+
+    return old_cost - new_cost;
 }
 
 /**
@@ -173,16 +236,8 @@ double fm_refiner_quadtree::evaluate_cost_function() {
     return cost;
 }
 
-double fm_refiner_quadtree::approx_log_faculty(double n) { // stirling formula: log of faculty of n
-    return (1.0 / std::log(2)) * (0.5 * std::log(2 * M_PI * n) + n * std::log(n / M_E));
-}
-
-double fm_refiner_quadtree::approx_log_binom(double n, double k) { // log of binomial coefficient using stirling formula
-    return approx_log_faculty(n) - approx_log_faculty(k) - approx_log_faculty(n - k);
-}
-
 double fm_refiner_quadtree::approx_quarter_cost(std::size_t from, std::size_t to) {
-    return approx_log_binom(m_partition_sizes[from] * m_partition_sizes[to], m_num_edges_from_to[from][to]);
+    return k2tree_cost::log_binom(m_partition_sizes[from] * m_partition_sizes[to], m_num_edges_from_to[from][to]);
     //if (from == 0 && to == 0) return approx_log_binom(m_partition_sizes[0] * m_partition_sizes[0], m_num_edges_from_to[0][0] + m_num_edges_from_to[0][1]);
     //if (from == 0 && to == 1) return approx_log_binom(m_partition_sizes[0] * m_partition_sizes[0], m_num_edges_from_to[1][0] + m_num_edges_from_to[1][1]);
     //if (from == 1 && to == 0) return approx_log_binom(m_partition_sizes[1] * m_partition_sizes[1], m_num_edges_from_to[0][0] + m_num_edges_from_to[0][1]);
@@ -203,7 +258,7 @@ std::vector<node_info> fm_refiner_quadtree::init_partition_info() {
     m_partition_sizes[1] = 0;
 
     for (NodeID v = 0; v < m_data_graph->number_of_nodes(); ++v) {
-        ++m_partition_sizes[m_data_graph->getPartitionIndex(v)];
+        ++m_partition_sizes[m_query_graph->get_partition(v)];
 
         nodes[v].node = v;
         nodes[v].marked = false;
@@ -212,12 +267,11 @@ std::vector<node_info> fm_refiner_quadtree::init_partition_info() {
 
         for (EdgeID e = m_data_graph->get_first_edge(v); e < m_data_graph->get_first_invalid_edge(v); ++e) {
             NodeID u = m_data_graph->getEdgeTarget(e);
-            PartitionID p = m_data_graph->getPartitionIndex(u);
+            PartitionID p = m_query_graph->get_partition(u);
             ++nodes[v].num_edges_to[p];
-            ++m_num_edges_from_to[m_data_graph->getPartitionIndex(v)][p];
+            ++m_num_edges_from_to[m_query_graph->get_partition(v)][p];
         }
     }
 
-    update_gain_values(nodes);
     return nodes;
 }
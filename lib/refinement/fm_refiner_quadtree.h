@@ -1,8 +1,11 @@
 #ifndef IMPL_FM_REFINER_QUADTREE_H
 #define IMPL_FM_REFINER_QUADTREE_H
 
+#include <cstdint>
+#include <unordered_map>
+
 #include "refiner_interface.h"
-#include "../data-structure/max_node_heap.h"
+#include "cost_models.h"
 
 namespace bathesis {
     struct node_info {
@@ -10,22 +13,41 @@ namespace bathesis {
         bool marked = false;
         double gain = 0.0;
         std::array<NodeID, 2> num_edges_to{0, 0};
+        std::size_t gain_class = 0;
+        std::size_t gain_class_position = 0;
+    };
+
+    /**
+     * The gain value of a node only depends on its partition and on its number of edges to each partition. Nodes
+     * that agree on those share a gain class.
+     */
+    struct gain_class {
+        PartitionID partition;
+        std::array<NodeID, 2> num_edges_to;
+        std::vector<NodeID> nodes; // unmarked nodes of this class
     };
 
     class fm_refiner_quadtree : public refiner_interface {
+        graph_access *m_data_graph; // data edges; the partition is kept by the query graph
+
         std::array<NodeID, 2> m_partition_sizes{0, 0};
         std::array<std::array<NodeID, 2>, 2> m_num_edges_from_to{std::array<NodeID, 2>{0, 0},
                                                              std::array<NodeID, 2>{0, 0}};
 
+        std::vector<gain_class> m_gain_classes;
+        std::array<std::unordered_map<std::uint64_t, std::size_t>, 2> m_gain_class_ids;
+
         void move_and_update(NodeID node, std::vector<node_info> &nodes);
 
-        void update_gain_values(std::vector<node_info> &nodes);
+        void insert_into_gain_class(NodeID node, std::vector<node_info> &nodes);
 
-        double evaluate_cost_function();
+        void remove_from_gain_class(NodeID node, std::vector<node_info> &nodes);
 
-        double approx_log_faculty(double n);
+        std::size_t find_max_gain_class(PartitionID partition, double &max_gain);
 
-        double approx_log_binom(double n, double k);
+        double calculate_gain(PartitionID partition, const std::array<NodeID, 2> &num_edges_to);
+
+        double evaluate_cost_function();
 
         double approx_quarter_cost(std::size_t from, std::size_t to);
 
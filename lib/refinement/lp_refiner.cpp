@@ -0,0 +1,218 @@
+#include <atomic>
+
+#include "lp_refiner.h"
+#include "../utils.h"
+
+using namespace bathesis;
+
+template<typename CostModel>
+lp_refiner<CostModel>::lp_refiner(int imbalance, int imbalance_level, bool boundary_only)
+        : refiner_interface(imbalance, imbalance_level), m_boundary_only(boundary_only) {
+}
+
+template<typename CostModel>
+NodeID lp_refiner<CostModel>::perform_refinement_iteration(int nth_iteration, int imbalance) {
+    if (nth_iteration == 0) {
+        m_partition_cost = calculate_partition_cost();
+    }
+    m_partition_sizes = m_query_graph->count_partition_sizes();
+    auto nonadjacent_base_cost = calculate_degrees();
+
+    // a partition may grow as long as the imbalance constraint is not violated; if it is already violated, nodes
+    // may only leave the larger partition
+    const NodeID n = m_query_graph->number_of_data_nodes();
+    const NodeID max_partition_size = std::max((n + 1) / 2, static_cast<NodeID>(n * (100.0 + imbalance) / 200.0));
+    std::atomic<NodeID> partition_sizes[2];
+    partition_sizes[0] = m_partition_sizes[0];
+    partition_sizes[1] = m_partition_sizes[1];
+
+    std::vector<NodeID> candidates;
+    if (m_boundary_only) {
+        candidates = find_boundary_candidates();
+    }
+    const NodeID num_candidates = m_boundary_only ? static_cast<NodeID>(candidates.size()) : n;
+
+    std::vector<std::pair<NodeID, double>> moves;
+
+#pragma omp parallel
+    {
+        std::vector<std::pair<NodeID, double>> local_moves;
+
+#pragma omp for schedule(dynamic, 1024) nowait
+        for (NodeID i = 0; i < num_candidates; ++i) {
+            NodeID v = m_boundary_only ? candidates[i] : i;
+            PartitionID p = m_query_graph->get_partition(v);
+            double gain = calculate_gain(v, p, nonadjacent_base_cost);
+            if (gain <= 1e-6) {
+                continue;
+            }
+
+            // reserve space in the other partition
+            if (partition_sizes[1 - p].fetch_add(1) + 1 > max_partition_size) {
+                partition_sizes[1 - p].fetch_sub(1);
+                continue;
+            }
+            partition_sizes[p].fetch_sub(1);
+
+            m_query_graph->set_partition(v, 1 - p);
+            for (NodeID q : m_query_graph->get_adjacent_query_nodes(v)) {
+#pragma omp atomic
+                --m_degrees[q][p];
+#pragma omp atomic
+                ++m_degrees[q][1 - p];
+            }
+
+            local_moves.emplace_back(v, gain);
+        }
+
+#pragma omp critical
+        moves.insert(moves.end(), local_moves.begin(), local_moves.end());
+    }
+
+    // the gains were estimated from the sizes at the start of the round, hence check the round as a whole
+    double partition_cost = calculate_partition_cost();
+    if (partition_cost >= m_partition_cost - 1e-6) {
+        for (auto &move : moves) {
+            m_query_graph->set_partition(move.first, 1 - m_query_graph->get_partition(move.first));
+        }
+        return 0;
+    }
+    m_partition_cost = partition_cost;
+
+    // the reporter is not thread-safe, hence report the moves afterwards
+    for (auto &move : moves) {
+        NodeID v = move.first;
+        PartitionID p = 1 - m_query_graph->get_partition(v);
+        bool is_boundary = m_query_graph->is_boundary_node(v);
+        m_reporter->refinement_move_node(*m_query_graph, v, p, move.second, 0, 0, is_boundary);
+    }
+
+    return static_cast<NodeID>(moves.size());
+}
+
+/**
+ * Counts the degrees of every query node and calculates the cost difference if a data node that is not adjacent to
+ * any query node is moved out of each partition.
+ *
+ * @return
+ */
+template<typename CostModel>
+std::array<double, 2> lp_refiner<CostModel>::calculate_degrees() {
+    const NodeID num_query_nodes = m_query_graph->number_of_query_nodes();
+    m_degrees.resize(num_query_nodes);
+
+    double nonadjacent_base_cost_0 = 0.0;
+    double nonadjacent_base_cost_1 = 0.0;
+
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: nonadjacent_base_cost_0, nonadjacent_base_cost_1)
+    for (NodeID q = 0; q < num_query_nodes; ++q) {
+        auto degrees = m_query_graph->count_query_node_degrees(q);
+        m_degrees[q] = degrees;
+
+        double cost = calculate_node_cost(m_partition_sizes, degrees);
+        if (m_partition_sizes[0] > 0 && degrees[0] < m_partition_sizes[0]) {
+            nonadjacent_base_cost_0 += cost - calculate_node_cost(
+                    std::array<NodeID, 2>{m_partition_sizes[0] - 1, m_partition_sizes[1] + 1},
+                    degrees
+            );
+        }
+        if (m_partition_sizes[1] > 0 && degrees[1] < m_partition_sizes[1]) {
+            nonadjacent_base_cost_1 += cost - calculate_node_cost(
+                    std::array<NodeID, 2>{m_partition_sizes[0] + 1, m_partition_sizes[1] - 1},
+                    degrees
+            );
+        }
+    }
+
+    return {nonadjacent_base_cost_0, nonadjacent_base_cost_1};
+}
+
+/**
+ * Collects the data nodes that are adjacent to a query node with neighbors in both partitions.
+ *
+ * @return the nodes in increasing order
+ */
+template<typename CostModel>
+std::vector<NodeID> lp_refiner<CostModel>::find_boundary_candidates() {
+    const NodeID n = m_query_graph->number_of_data_nodes();
+    std::vector<char> is_candidate(n, false);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID q = 0; q < m_query_graph->number_of_query_nodes(); ++q) {
+        if (m_degrees[q][0] == 0 || m_degrees[q][1] == 0) {
+            continue;
+        }
+        for (NodeID v : m_query_graph->get_adjacent_data_nodes(q)) {
+#pragma omp atomic write
+            is_candidate[v] = true;
+        }
+    }
+
+    std::vector<NodeID> candidates;
+    for (NodeID v = 0; v < n; ++v) {
+        if (is_candidate[v]) {
+            candidates.push_back(v);
+        }
+    }
+    return candidates;
+}
+
+/**
+ * Calculates the cost improvement if {@code node} is moved out of {@code partition}, based on the current degrees of
+ * its query nodes.
+ *
+ * @param node
+ * @param partition the partition that currently contains {@code node}
+ * @param nonadjacent_base_cost
+ * @return
+ */
+template<typename CostModel>
+double lp_refiner<CostModel>::calculate_gain(NodeID node, PartitionID partition,
+                                  const std::array<double, 2> &nonadjacent_base_cost) {
+    const PartitionID p = partition;
+    std::array<NodeID, 2> moved_partition_sizes = m_partition_sizes;
+    --moved_partition_sizes[p];
+    ++moved_partition_sizes[1 - p];
+
+    double gain = nonadjacent_base_cost[p];
+    for (NodeID q : m_query_graph->get_adjacent_query_nodes(node)) {
+        std::array<NodeID, 2> degrees;
+#pragma omp atomic read
+        degrees[0] = m_degrees[q][0];
+#pragma omp atomic read
+        degrees[1] = m_degrees[q][1];
+        assert(degrees[p] > 0);
+
+        double cost = calculate_node_cost(m_partition_sizes, degrees);
+
+        // replace the contribution of a nonadjacent node by the contribution of an adjacent node
+        if (m_partition_sizes[p] > 0 && degrees[p] < m_partition_sizes[p]) {
+            gain -= cost - calculate_node_cost(moved_partition_sizes, degrees);
+        }
+        std::array<NodeID, 2> moved_degrees = degrees;
+        --moved_degrees[p];
+        ++moved_degrees[1 - p];
+        gain += cost - calculate_node_cost(moved_partition_sizes, moved_degrees);
+    }
+
+    return gain;
+}
+
+template<typename CostModel>
+double
+lp_refiner<CostModel>::calculate_node_cost(const std::array<NodeID, 2> &partition_sizes, const std::array<NodeID, 2> &degrees) {
+    // degrees are updated concurrently, hence degrees[i] might exceed partition_sizes[i] during a round
+    return calculate_query_node_cost<CostModel>(partition_sizes, degrees);
+}
+
+template<typename CostModel>
+double lp_refiner<CostModel>::calculate_partition_cost() {
+    return utils::calculate_partition_cost<CostModel>(*m_query_graph);
+}
+
+namespace bathesis {
+    template class lp_refiner<loggap_cost>;
+    template class lp_refiner<log_cost>;
+    template class lp_refiner<mla_cost>;
+    template class lp_refiner<k2tree_cost>;
+}
@@ -0,0 +1,52 @@
+#ifndef IMPL_LP_REFINER_H
+#define IMPL_LP_REFINER_H
+
+#include "refiner_interface.h"
+#include "cost_models.h"
+
+namespace bathesis {
+
+    /**
+     * Size-constrained label propagation on the bipartite objective.
+     *
+     * In every iteration, each data node checks in parallel whether moving it to the other partition lowers the
+     * partition cost and moves if the target partition still has room according to the imbalance. The degrees of
+     * the query nodes are updated atomically, i.e. nodes see the moves made earlier during the same round.
+     *
+     * The gains are estimates: the partition sizes and the cost of moving a nonadjacent node are taken at the start
+     * of the round. Hence a round whose moves do not lower the partition cost is undone and ends the refinement.
+     *
+     * In boundary-only mode, a round only visits the data nodes that are adjacent to a query node with neighbors in
+     * both partitions at the start of the round.
+     *
+     * @tparam CostModel estimate of the cost of a query node, see cost_models.h
+     */
+    template<typename CostModel = loggap_cost>
+    class lp_refiner : public refiner_interface {
+        std::array<NodeID, 2> m_partition_sizes{0, 0};
+
+        double m_partition_cost = 0.0; // partition cost at the end of the previous round
+
+        bool m_boundary_only;
+
+        numa_vector<std::array<NodeID, 2>> m_degrees;
+
+        std::array<double, 2> calculate_degrees();
+
+        std::vector<NodeID> find_boundary_candidates();
+
+        double calculate_gain(NodeID node, PartitionID partition, const std::array<double, 2> &nonadjacent_base_cost);
+
+        double calculate_node_cost(const std::array<NodeID, 2> &partition_sizes, const std::array<NodeID, 2> &degrees);
+
+    protected:
+        NodeID perform_refinement_iteration(int nth_iteration, int imbalance);
+
+        double calculate_partition_cost();
+
+    public:
+        lp_refiner(int imbalance = 3, int imbalance_level = 1, bool boundary_only = false);
+    };
+}
+
+#endif // IMPL_LP_REFINER_H
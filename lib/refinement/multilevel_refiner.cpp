@@ -0,0 +1,65 @@
+#include "multilevel_refiner.h"
+#include "../utils.h"
+
+using namespace bathesis;
+
+template<typename CostModel>
+multilevel_refiner<CostModel>::multilevel_refiner(int imbalance, int imbalance_level, NodeID contraction_limit,
+                                                  int rounds_per_level)
+        : refiner_interface(imbalance, imbalance_level),
+          m_contraction_limit(contraction_limit),
+          m_rounds_per_level(rounds_per_level) {
+}
+
+template<typename CostModel>
+NodeID multilevel_refiner<CostModel>::perform_refinement_iteration(int nth_iteration, int imbalance) {
+    std::vector<std::vector<NodeID>> maps;
+    auto hierarchy = m_coarsener.build_hierarchy(weighted_query_graph(*m_query_graph), m_contraction_limit, maps);
+    double initial_cost = hierarchy.front().calculate_partition_cost<CostModel>();
+
+    // refine from the coarsest level down and project the partition in each step
+    while (true) {
+        m_refiner.perform_refinement(hierarchy.back(), m_rounds_per_level, imbalance);
+        if (hierarchy.size() == 1) {
+            break;
+        }
+
+        hierarchy.back().project_partition(hierarchy[hierarchy.size() - 2], maps.back());
+        hierarchy.pop_back();
+        maps.pop_back();
+    }
+
+    // label propagation works with partially outdated gain values, hence the V-cycle might not improve the partition
+    auto &finest = hierarchy.front();
+    if (finest.calculate_partition_cost<CostModel>() >= initial_cost - 1e-6) {
+        return 0;
+    }
+
+    // apply the refined partition to the query graph
+    std::vector<NodeID> moved_nodes;
+    for (NodeID v = 0; v < m_query_graph->number_of_data_nodes(); ++v) {
+        if (m_query_graph->get_partition(v) != finest.get_partition(v)) {
+            moved_nodes.push_back(v);
+        }
+    }
+
+    for (NodeID v : moved_nodes) {
+        m_query_graph->set_partition(v, finest.get_partition(v));
+    }
+    for (NodeID v : moved_nodes) {
+        m_reporter->refinement_move_node(*m_query_graph, v, 1 - finest.get_partition(v), 0, 0, 0,
+                                         m_query_graph->is_boundary_node(v));
+    }
+
+    return static_cast<NodeID>(moved_nodes.size());
+}
+
+template<typename CostModel>
+double multilevel_refiner<CostModel>::calculate_partition_cost() {
+    return utils::calculate_partition_cost<CostModel>(*m_query_graph);
+}
+
+namespace bathesis {
+    template class multilevel_refiner<loggap_cost>;
+    template class multilevel_refiner<mla_cost>;
+}
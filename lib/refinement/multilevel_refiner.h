@@ -0,0 +1,42 @@
+#ifndef IMPL_MULTILEVEL_REFINER_H
+#define IMPL_MULTILEVEL_REFINER_H
+
+#include "refiner_interface.h"
+#include "cost_models.h"
+#include "weighted_lp_refiner.h"
+#include "../coarsening/overlap_coarsener.h"
+
+namespace bathesis {
+
+    /**
+     * Refines the partition on a hierarchy of contracted graphs.
+     *
+     * Every refinement iteration is a V-cycle: data nodes of the same partition with a high overlap of their query
+     * neighborhoods are contracted until the graph is small, then the partition is refined from the coarsest level
+     * down and projected to the next finer level in each step. Moving a coarse node moves a whole group of data
+     * nodes at once.
+     *
+     * @tparam CostModel separable estimate of the cost of a query node, see {@code weighted_lp_refiner}
+     */
+    template<typename CostModel = loggap_cost>
+    class multilevel_refiner : public refiner_interface {
+        NodeID m_contraction_limit;
+
+        int m_rounds_per_level;
+
+        overlap_coarsener m_coarsener;
+
+        weighted_lp_refiner<CostModel> m_refiner;
+
+    protected:
+        NodeID perform_refinement_iteration(int nth_iteration, int imbalance);
+
+        double calculate_partition_cost();
+
+    public:
+        multilevel_refiner(int imbalance = 3, int imbalance_level = 1, NodeID contraction_limit = 2000,
+                           int rounds_per_level = 5);
+    };
+}
+
+#endif // IMPL_MULTILEVEL_REFINER_H
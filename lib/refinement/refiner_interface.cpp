@@ -1,23 +1,42 @@
 #include "refiner_interface.h"
 #include "../utils.h"
 
+#include <tools/timer.h>
+
 using namespace bathesis;
 
 refiner_interface::refiner_interface(int imbalance, int imbalance_level)
     : m_imbalance(imbalance), m_imbalance_level(imbalance_level) {
 }
 
-void refiner_interface::perform_refinement(query_graph &query_graph, int max_iterations, int level, reporter &reporter) {
+/**
+ * Refines the partition of {@code query_graph} until an iteration moves no nodes, {@code max_iterations} iterations
+ * were performed or {@code time_limit} seconds have passed. The time limit is only checked between iterations.
+ *
+ * @param query_graph
+ * @param max_iterations
+ * @param level recursion level
+ * @param reporter
+ * @param time_limit in seconds
+ */
+void refiner_interface::perform_refinement(query_graph &query_graph, int max_iterations, int level, reporter &reporter,
+                                           double time_limit) {
     m_query_graph = &query_graph;
-    m_data_graph = &query_graph.data_graph();
     m_reporter = &reporter;
 
-    double initial_cost = utils::calculate_partition_cost(*m_query_graph);
+    double initial_cost = calculate_partition_cost();
     double pre_iteration_cost = initial_cost;
     m_reporter->refinement_start(query_graph, initial_cost);
 
+    timer refinement_timer;
+    refinement_timer.restart();
+
     int i = 0;
     for (i = 0; i < max_iterations; ++i) {
+        if (refinement_timer.elapsed() >= time_limit) {
+            break;
+        }
+
         int imbalance = 3;
         if (level % m_imbalance_level == 0) {
             imbalance = m_imbalance;
@@ -26,7 +45,7 @@ void refiner_interface::perform_refinement(query_graph &query_graph, int max_ite
         // perform a single refinement iterations
         reporter.refinement_iteration_start(query_graph, i, pre_iteration_cost);
         NodeID nodes_moved = perform_refinement_iteration(i, imbalance);
-        double post_iteration_cost = utils::calculate_partition_cost(*m_query_graph);
+        double post_iteration_cost = calculate_partition_cost();
         reporter.refinement_iteration_finish(query_graph, nodes_moved, post_iteration_cost);
         pre_iteration_cost = post_iteration_cost;
 
@@ -39,3 +58,12 @@ void refiner_interface::perform_refinement(query_graph &query_graph, int max_ite
     // pre_iteration_cost is the resulting partition cost
     m_reporter->refinement_finish(query_graph, i, pre_iteration_cost);
 }
+
+/**
+ * Evaluates the objective that the refiner optimizes on the current partition; used for reporting.
+ *
+ * @return
+ */
+double refiner_interface::calculate_partition_cost() {
+    return utils::calculate_partition_cost(*m_query_graph);
+}
@@ -1,6 +1,8 @@
 #ifndef IMPL_REFINEMENT_H
 #define IMPL_REFINEMENT_H
 
+#include <limits>
+
 #include <data_structure/graph_access.h>
 
 #include "../data-structure/query_graph.h"
@@ -10,7 +12,6 @@ namespace bathesis {
     class refiner_interface {
     protected:
         query_graph *m_query_graph;
-        graph_access *m_data_graph;
         reporter *m_reporter;
 
         int m_imbalance_level;
@@ -18,10 +19,13 @@ namespace bathesis {
 
         virtual NodeID perform_refinement_iteration(int nth_iteration, int imbalance) = 0;
 
+        virtual double calculate_partition_cost();
+
     public:
         refiner_interface(int imbalance = 3, int imbalance_level = 1);
 
-        void perform_refinement(query_graph &query_graph, int max_iterations, int level, reporter &reporter);
+        void perform_refinement(query_graph &query_graph, int max_iterations, int level, reporter &reporter,
+                                double time_limit = std::numeric_limits<double>::infinity());
     };
 }
 
@@ -0,0 +1,51 @@
+#include "time_budget.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace bathesis;
+
+/**
+ * @param seconds total time for refinement; unlimited if not positive
+ */
+time_budget::time_budget(double seconds) : m_seconds(seconds) {
+}
+
+/**
+ * Starts the clock.
+ *
+ * @param number_of_nodes number of data nodes of the input graph
+ * @param number_of_levels number of recursion levels that perform a bisection
+ */
+void time_budget::start(NodeID number_of_nodes, int number_of_levels) {
+    m_remaining_work = static_cast<double>(number_of_nodes) * std::max(number_of_levels, 1);
+    m_timer.restart();
+}
+
+bool time_budget::is_limited() const {
+    return m_seconds > 0.0;
+}
+
+double time_budget::remaining_time() {
+    if (!is_limited()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return std::max(0.0, m_seconds - m_timer.elapsed());
+}
+
+/**
+ * Claims the time for the refinement of a bisection.
+ *
+ * @param number_of_nodes number of data nodes of the bisected subgraph
+ * @return time in seconds
+ */
+double time_budget::claim(NodeID number_of_nodes) {
+    if (!is_limited()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double work = std::min(static_cast<double>(number_of_nodes), m_remaining_work);
+    double share = (m_remaining_work > 0.0) ? work / m_remaining_work : 1.0;
+    m_remaining_work -= work;
+    return remaining_time() * share;
+}
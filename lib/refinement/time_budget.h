@@ -0,0 +1,36 @@
+#ifndef IMPL_TIME_BUDGET_H
+#define IMPL_TIME_BUDGET_H
+
+#include <tools/timer.h>
+
+#include <data_structure/graph_access.h>
+
+namespace bathesis {
+
+    /**
+     * Wall-clock time budget for the refinement of all bisections of a run.
+     *
+     * Refining a bisection of a subgraph with n data nodes counts as n units of work; a run with L recursion levels
+     * on N data nodes does at most N * L units. Each bisection claims the share of the remaining time that matches
+     * its share of the remaining work. Time that is not used by a bisection, e.g. because the refiner converged
+     * early, is passed on to the following ones; time spent outside of refinement is taken from them.
+     */
+    class time_budget {
+        double m_seconds;
+        double m_remaining_work = 0.0;
+        timer m_timer;
+
+    public:
+        explicit time_budget(double seconds = 0.0);
+
+        void start(NodeID number_of_nodes, int number_of_levels);
+
+        bool is_limited() const;
+
+        double remaining_time();
+
+        double claim(NodeID number_of_nodes);
+    };
+}
+
+#endif // IMPL_TIME_BUDGET_H
@@ -0,0 +1,137 @@
+#include <atomic>
+
+#include "weighted_lp_refiner.h"
+
+using namespace bathesis;
+
+/**
+ * Performs up to {@code max_rounds} rounds of label propagation.
+ *
+ * @param G
+ * @param max_rounds
+ * @param imbalance maximal imbalance in percent
+ * @return the number of moved data nodes
+ */
+template<typename CostModel>
+NodeID weighted_lp_refiner<CostModel>::perform_refinement(weighted_query_graph &G, int max_rounds, int imbalance) {
+    const NodeID n = G.number_of_data_nodes();
+    auto weights = G.calculate_partition_weights();
+    const NodeID total_weight = weights[0] + weights[1];
+    const NodeID max_partition_weight = std::max((total_weight + 1) / 2,
+                                                 static_cast<NodeID>(total_weight * (100.0 + imbalance) / 200.0));
+
+    NodeID total_moved = 0;
+    for (int round = 0; round < max_rounds; ++round) {
+        calculate_degrees(G);
+
+        std::atomic<NodeID> partition_weights[2];
+        partition_weights[0] = static_cast<NodeID>(m_partition_weights[0]);
+        partition_weights[1] = static_cast<NodeID>(m_partition_weights[1]);
+
+        NodeID moved = 0;
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: moved)
+        for (NodeID v = 0; v < n; ++v) {
+            if (calculate_gain(G, v) <= 1e-6) {
+                continue;
+            }
+
+            PartitionID p = G.get_partition(v);
+            NodeID w = G.get_node_weight(v);
+            if (partition_weights[1 - p].fetch_add(w) + w > max_partition_weight) {
+                partition_weights[1 - p].fetch_sub(w);
+                continue;
+            }
+            partition_weights[p].fetch_sub(w);
+
+            G.set_partition(v, 1 - p);
+            for (EdgeID e = G.get_first_data_edge(v); e < G.get_first_invalid_data_edge(v); ++e) {
+                NodeID q = G.get_data_edge_target(e);
+                NodeID m = G.get_data_edge_weight(e);
+#pragma omp atomic
+                m_degrees[q][p] -= m;
+#pragma omp atomic
+                m_degrees[q][1 - p] += m;
+            }
+            ++moved;
+        }
+
+        total_moved += moved;
+        if (moved == 0) {
+            break;
+        }
+    }
+
+    return total_moved;
+}
+
+template<typename CostModel>
+void weighted_lp_refiner<CostModel>::calculate_degrees(const weighted_query_graph &G) {
+    m_degrees.resize(G.number_of_query_nodes());
+
+    double factors_0 = 0.0;
+    double factors_1 = 0.0;
+
+#pragma omp parallel for schedule(dynamic, 1024) reduction(+: factors_0, factors_1)
+    for (NodeID q = 0; q < G.number_of_query_nodes(); ++q) {
+        std::array<NodeID, 2> degrees = {0, 0};
+        for (EdgeID e = G.get_first_query_edge(q); e < G.get_first_invalid_query_edge(q); ++e) {
+            degrees[G.get_partition(G.get_query_edge_target(e))] += G.get_query_edge_weight(e);
+        }
+        m_degrees[q] = degrees;
+        factors_0 += CostModel::degree_factor(degrees[0]);
+        factors_1 += CostModel::degree_factor(degrees[1]);
+    }
+
+    auto weights = G.calculate_partition_weights();
+    m_partition_weights = {static_cast<double>(weights[0]), static_cast<double>(weights[1])};
+    m_partition_factors = {factors_0, factors_1};
+}
+
+/**
+ * Calculates the cost improvement if {@code node} is moved to the other partition.
+ *
+ * The partition weights and the summed degree factors of each partition are taken from the start of the round, the
+ * degrees of the query nodes are up to date.
+ *
+ * @param G
+ * @param node
+ * @return
+ */
+template<typename CostModel>
+double weighted_lp_refiner<CostModel>::calculate_gain(const weighted_query_graph &G, NodeID node) {
+    const PartitionID p = G.get_partition(node);
+    const PartitionID o = 1 - p;
+    const double w = G.get_node_weight(node);
+
+    double gain = 0.0;
+    std::array<double, 2> factor_change = {0.0, 0.0};
+    for (EdgeID e = G.get_first_data_edge(node); e < G.get_first_invalid_data_edge(node); ++e) {
+        NodeID q = G.get_data_edge_target(e);
+        double m = G.get_data_edge_weight(e);
+
+        std::array<NodeID, 2> degrees;
+#pragma omp atomic read
+        degrees[0] = m_degrees[q][0];
+#pragma omp atomic read
+        degrees[1] = m_degrees[q][1];
+        const double d_p = degrees[p];
+        const double d_o = degrees[o];
+
+        gain += CostModel::degree_term(d_p) + CostModel::degree_term(d_o);
+        gain -= CostModel::degree_term(d_p - m) + CostModel::degree_term(d_o + m);
+        factor_change[p] += CostModel::degree_factor(d_p - m) - CostModel::degree_factor(d_p);
+        factor_change[o] += CostModel::degree_factor(d_o + m) - CostModel::degree_factor(d_o);
+    }
+
+    gain += CostModel::size_factor(m_partition_weights[p]) * m_partition_factors[p];
+    gain += CostModel::size_factor(m_partition_weights[o]) * m_partition_factors[o];
+    gain -= CostModel::size_factor(m_partition_weights[p] - w) * (m_partition_factors[p] + factor_change[p]);
+    gain -= CostModel::size_factor(m_partition_weights[o] + w) * (m_partition_factors[o] + factor_change[o]);
+
+    return gain;
+}
+
+namespace bathesis {
+    template class weighted_lp_refiner<loggap_cost>;
+    template class weighted_lp_refiner<mla_cost>;
+}
@@ -0,0 +1,40 @@
+#ifndef IMPL_WEIGHTED_LP_REFINER_H
+#define IMPL_WEIGHTED_LP_REFINER_H
+
+#include "cost_models.h"
+#include "../data-structure/weighted_query_graph.h"
+
+namespace bathesis {
+
+    /**
+     * Size-constrained label propagation on a {@code weighted_query_graph}, used on the levels of the multilevel
+     * algorithms.
+     *
+     * Works like {@code lp_refiner}, but the gain of a move accounts for the weights of the data node and its edges.
+     * Moving a data node of weight w changes the size of both partitions by w, hence the cost of every query node
+     * changes. The gain is computed in time linear in the degree of the data node from the separable form of the
+     * cost model, see cost_models.h; non-separable models like {@code log_cost} and {@code k2tree_cost} are not
+     * supported.
+     *
+     * @tparam CostModel separable estimate of the cost of a query node, see cost_models.h
+     */
+    template<typename CostModel = loggap_cost>
+    class weighted_lp_refiner {
+        static_assert(CostModel::is_separable, "weighted_lp_refiner requires a separable cost model");
+
+        numa_vector<std::array<NodeID, 2>> m_degrees;
+
+        std::array<double, 2> m_partition_weights{0.0, 0.0};
+
+        std::array<double, 2> m_partition_factors{0.0, 0.0}; // sum of degree_factor over all query nodes
+
+        void calculate_degrees(const weighted_query_graph &G);
+
+        double calculate_gain(const weighted_query_graph &G, NodeID node);
+
+    public:
+        NodeID perform_refinement(weighted_query_graph &G, int max_rounds, int imbalance);
+    };
+}
+
+#endif // IMPL_WEIGHTED_LP_REFINER_H
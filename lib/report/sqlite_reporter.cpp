@@ -96,7 +96,7 @@ void sqlite_reporter::start(query_graph &QG, const std::string &filename,
         "VALUES (?, ?, ?, ?, ?, ?, ?);");
     sqlite3_bind_text(stmt, 1, filename.c_str(), -1, nullptr);
     sqlite3_bind_text(stmt, 2, remark.c_str(), -1, nullptr);
-    sqlite3_bind_int(stmt, 3, QG.data_graph().number_of_nodes());
+    sqlite3_bind_int(stmt, 3, QG.number_of_data_nodes());
     sqlite3_bind_int(stmt, 4, QG.data_graph().number_of_edges());
     sqlite3_bind_double(stmt, 5, initial_loggap);
     sqlite3_bind_double(stmt, 6, initial_log);
@@ -137,7 +137,7 @@ void sqlite_reporter::bisection_start(query_graph &QG) {
         "(?, ?, ?, ?);");
     sqlite3_bind_int64(stmt, 1, m_report_id);
     sqlite3_bind_text(stmt, 2, m_branch_identifier.c_str(), -1, nullptr);
-    sqlite3_bind_int(stmt, 3, QG.data_graph().number_of_nodes());
+    sqlite3_bind_int(stmt, 3, QG.number_of_data_nodes());
     sqlite3_bind_int(stmt, 4, QG.data_graph().number_of_edges());
     exec(stmt);
 
@@ -148,10 +148,10 @@ void sqlite_reporter::bisection_finish(query_graph &QG,
                                        query_graph &first_subgraph,
                                        query_graph &second_subgraph) {
     double imbalance = std::abs(
-        static_cast<long>(first_subgraph.data_graph().number_of_nodes()) -
-        static_cast<long>(second_subgraph.data_graph().number_of_nodes()));
-    imbalance /= first_subgraph.data_graph().number_of_nodes() +
-                 second_subgraph.data_graph().number_of_nodes();
+        static_cast<long>(first_subgraph.number_of_data_nodes()) -
+        static_cast<long>(second_subgraph.number_of_data_nodes()));
+    imbalance /= first_subgraph.number_of_data_nodes() +
+                 second_subgraph.number_of_data_nodes();
     imbalance *= 100;
 
     sqlite3_stmt *stmt = prepare(
@@ -159,11 +159,11 @@ void sqlite_reporter::bisection_finish(query_graph &QG,
         "SET `p0_nodes` = ?, `p0_edges` = ?, `p1_nodes` = ?, `p1_edges` = ?, "
         "`cut` = ?, `imbalance` = ? "
         "WHERE `id` = ?;");
-    sqlite3_bind_int(stmt, 1, first_subgraph.data_graph().number_of_nodes());
+    sqlite3_bind_int(stmt, 1, first_subgraph.number_of_data_nodes());
     sqlite3_bind_int(stmt, 2, first_subgraph.data_graph().number_of_edges());
-    sqlite3_bind_int(stmt, 3, second_subgraph.data_graph().number_of_nodes());
+    sqlite3_bind_int(stmt, 3, second_subgraph.number_of_data_nodes());
     sqlite3_bind_int(stmt, 4, second_subgraph.data_graph().number_of_edges());
-    sqlite3_bind_int(stmt, 5, quality_metrics().edge_cut(QG.data_graph()));
+    sqlite3_bind_int(stmt, 5, quality_metrics().edge_cut(QG.synchronized_data_graph()));
     sqlite3_bind_int(stmt, 6, static_cast<int>(imbalance));
     sqlite3_bind_int64(stmt, 7, m_bisection_id);
     exec(stmt);
@@ -174,7 +174,7 @@ void sqlite_reporter::initial_partitioning_finish(query_graph &QG) {
         "UPDATE `bisection` SET `partitioning_time` = ?, `initial_cut` = ? "
         "WHERE `id` = ?;");
     sqlite3_bind_double(stmt, 1, m_initial_partition_time.elapsed());
-    sqlite3_bind_int(stmt, 2, quality_metrics().edge_cut(QG.data_graph()));
+    sqlite3_bind_int(stmt, 2, quality_metrics().edge_cut(QG.synchronized_data_graph()));
     sqlite3_bind_int64(stmt, 3, m_bisection_id);
     exec(stmt);
 }
@@ -226,13 +226,13 @@ void sqlite_reporter::refinement_move_node(
     std::array<NodeID, 2> degrees = {0, 0};
     forall_out_edges(QG.data_graph(), edge, node) NodeID neighbor =
         QG.data_graph().getEdgeTarget(edge);
-    ++degrees[QG.data_graph().getPartitionIndex(neighbor)];
+    ++degrees[QG.get_partition(neighbor)];
     endfor
 
         std::array<NodeID, 2>
             query_degrees = {0, 0};
     auto adjacent_query_nodes = QG.get_adjacent_query_nodes(node);
-    for (auto &q : adjacent_query_nodes) {
+    for (NodeID q : adjacent_query_nodes) {
         auto q_degrees = QG.count_query_node_degrees(q);
         query_degrees[0] += q_degrees[0];
         query_degrees[1] += q_degrees[1];
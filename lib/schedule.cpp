@@ -0,0 +1,73 @@
+#include "schedule.h"
+
+using namespace bathesis;
+
+bool schedule_condition::holds(query_graph &QG) const {
+    std::uint64_t actual = 0;
+    switch (prop) {
+        case property::depth:
+            // the branch id of a subgraph at depth d has d + 1 bits
+            for (std::uint64_t branch_id = QG.branch_id(); branch_id > 1; branch_id >>= 1) {
+                ++actual;
+            }
+            break;
+        case property::nodes:
+            actual = QG.number_of_data_nodes();
+            break;
+        case property::edges:
+            actual = QG.number_of_query_edges();
+            break;
+    }
+
+    switch (cmp) {
+        case comparison::less:
+            return actual < value;
+        case comparison::less_equal:
+            return actual <= value;
+        case comparison::greater:
+            return actual > value;
+        case comparison::greater_equal:
+            return actual >= value;
+        case comparison::equal:
+            return actual == value;
+    }
+    return false;
+}
+
+/**
+ * Parses a condition of the form {@code <depth|nodes|edges><<|<=|>|>=|=><value>}.
+ *
+ * @throws std::invalid_argument if the condition is malformed
+ * @param condition
+ * @return
+ */
+schedule_condition schedule_condition::parse(const std::string &condition) {
+    const std::map<std::string, property> properties = {
+            {"depth", property::depth},
+            {"nodes", property::nodes},
+            {"edges", property::edges}
+    };
+    // two-character operators first, so that "<=" is not read as "<"
+    const std::vector<std::pair<std::string, comparison>> comparisons = {
+            {"<=", comparison::less_equal},
+            {">=", comparison::greater_equal},
+            {"<",  comparison::less},
+            {">",  comparison::greater},
+            {"=",  comparison::equal}
+    };
+
+    for (auto &candidate : comparisons) {
+        std::size_t position = condition.find(candidate.first);
+        if (position == std::string::npos) {
+            continue;
+        }
+
+        auto prop = properties.find(condition.substr(0, position));
+        std::string value = condition.substr(position + candidate.first.size());
+        if (prop == properties.end() || value.empty() || value.find_first_not_of("0123456789") != std::string::npos) {
+            break;
+        }
+        return {prop->second, candidate.second, std::stoull(value)};
+    }
+    throw std::invalid_argument("malformed schedule condition '" + condition + "'");
+}
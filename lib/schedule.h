@@ -0,0 +1,145 @@
+#ifndef IMPL_SCHEDULE_H
+#define IMPL_SCHEDULE_H
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "data-structure/query_graph.h"
+#include "initial-partitioner/initial_partitioner_interface.h"
+#include "refinement/refiner_interface.h"
+
+namespace bathesis {
+
+    /**
+     * Condition on a subproblem of the recursive bisection, e.g. {@code nodes >= 100000}.
+     *
+     * The depth of the root graph is 0, the depth of its subgraphs is 1 and so on; edges are query edges.
+     */
+    struct schedule_condition {
+        enum class property {
+            depth, nodes, edges
+        };
+
+        enum class comparison {
+            less, less_equal, greater, greater_equal, equal
+        };
+
+        property prop;
+        comparison cmp;
+        std::uint64_t value;
+
+        bool holds(query_graph &QG) const;
+
+        static schedule_condition parse(const std::string &condition);
+    };
+
+    /**
+     * Selects the initial partitioner or refiner for each subproblem of the recursive bisection.
+     *
+     * A schedule is a list of rules, each one a component and a set of conditions. The first rule whose conditions
+     * all hold for the subproblem applies; if there is none, the last rule applies.
+     *
+     * Schedules can be given as strings of the form
+     *
+     *     rule;rule;...      with rule = name[:condition,condition,...]
+     *
+     * e.g. {@code "kahip:nodes>=1000000;growing"} or {@code "lp:depth<2;fm:nodes<100000;basic"}. A single name
+     * uses the same component on all subproblems.
+     *
+     * @tparam Component {@code initial_partitioner_interface} or {@code refiner_interface}
+     */
+    template<typename Component>
+    class schedule {
+        struct rule {
+            Component *component;
+            std::vector<schedule_condition> conditions;
+        };
+
+        std::vector<rule> m_rules;
+
+    public:
+        schedule() = default;
+
+        explicit schedule(Component &component) {
+            add_rule(component);
+        }
+
+        void add_rule(Component &component, std::vector<schedule_condition> conditions = {}) {
+            m_rules.push_back({&component, std::move(conditions)});
+        }
+
+        Component &select(query_graph &QG) const;
+
+        static schedule parse(const std::string &specification, const std::map<std::string, Component *> &components);
+    };
+
+    using partitioner_schedule = schedule<initial_partitioner_interface>;
+
+    using refiner_schedule = schedule<refiner_interface>;
+
+    template<typename Component>
+    Component &schedule<Component>::select(query_graph &QG) const {
+        assert(!m_rules.empty());
+
+        for (auto &rule : m_rules) {
+            bool applies = true;
+            for (auto &condition : rule.conditions) {
+                applies = applies && condition.holds(QG);
+            }
+            if (applies) {
+                return *rule.component;
+            }
+        }
+        return *m_rules.back().component;
+    }
+
+    /**
+     * Parses a schedule of the named components.
+     *
+     * @throws std::invalid_argument if the specification is malformed or names an unknown component
+     * @param specification
+     * @param components
+     * @return
+     */
+    template<typename Component>
+    schedule<Component> schedule<Component>::parse(const std::string &specification,
+                                                   const std::map<std::string, Component *> &components) {
+        auto split = [](const std::string &string, char separator) {
+            std::vector<std::string> parts;
+            std::size_t begin = 0;
+            while (true) {
+                std::size_t end = string.find(separator, begin);
+                parts.push_back(string.substr(begin, end - begin));
+                if (end == std::string::npos) {
+                    return parts;
+                }
+                begin = end + 1;
+            }
+        };
+
+        schedule result;
+        for (auto &rule_specification : split(specification, ';')) {
+            std::size_t colon = rule_specification.find(':');
+            std::string name = rule_specification.substr(0, colon);
+
+            auto component = components.find(name);
+            if (component == components.end()) {
+                throw std::invalid_argument("unknown component '" + name + "' in schedule '" + specification + "'");
+            }
+
+            std::vector<schedule_condition> conditions;
+            if (colon != std::string::npos) {
+                for (auto &condition : split(rule_specification.substr(colon + 1), ',')) {
+                    conditions.push_back(schedule_condition::parse(condition));
+                }
+            }
+            result.add_rule(*component->second, std::move(conditions));
+        }
+        return result;
+    }
+}
+
+#endif // IMPL_SCHEDULE_H
@@ -1,13 +1,13 @@
 #include "utils.h"
 
 #include <io/graph_io.h>
-#include <tools/quality_metrics.h>
 
 #include <algorithm>
 #include <cmath>
 #include <ctime>
 #include <functional>
 #include <numeric>
+#include <parallel/algorithm>
 #include <random>
 
 using namespace bathesis;
@@ -20,6 +20,26 @@ using namespace bathesis;
  */
 double utils::log(double arg) { return 1 + std::log2(arg); }
 
+/**
+ * Derives the seed of a task from the global seed and the position of its
+ * subgraph in the recursion tree, hence the seed does not depend on the order
+ * in which tasks run.
+ *
+ * @param seed global seed
+ * @param branch_id see query_graph::branch_id()
+ * @param index distinguishes several tasks on the same subgraph
+ * @return
+ */
+uint utils::derive_seed(uint seed, std::uint64_t branch_id, uint index) {
+    // splitmix64 finalizer
+    std::uint64_t z = (static_cast<std::uint64_t>(seed) << 32) ^ index;
+    z += 0x9e3779b97f4a7c15ULL * branch_id;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return static_cast<uint>(z);
+}
+
 /**
  * Builds the identity linear layout.
  *
@@ -41,6 +61,43 @@ std::vector<NodeID> utils::create_random_layout(graph_access &G) {
     return id;
 }
 
+/**
+ * Orders the nodes by breadth-first search, starting a new search from the
+ * unvisited node with the lowest id whenever a component is exhausted.
+ *
+ * @param G
+ * @return linear layout
+ */
+std::vector<NodeID> utils::create_bfs_layout(graph_access &G) {
+    std::vector<NodeID> layout(G.number_of_nodes(), UINT_MAX);
+    std::vector<NodeID> queue;
+    queue.reserve(G.number_of_nodes());
+
+    forall_nodes(G, start) {
+        if (layout[start] != UINT_MAX) {
+            continue;
+        }
+
+        std::size_t head = queue.size();
+        layout[start] = static_cast<NodeID>(queue.size());
+        queue.push_back(start);
+        while (head < queue.size()) {
+            NodeID v = queue[head++];
+            forall_out_edges(G, e, v) {
+                NodeID u = G.getEdgeTarget(e);
+                if (layout[u] == UINT_MAX) {
+                    layout[u] = static_cast<NodeID>(queue.size());
+                    queue.push_back(u);
+                }
+            }
+            endfor
+        }
+    }
+    endfor
+
+    return layout;
+}
+
 std::vector<NodeID> utils::invert_linear_layout(
     std::vector<NodeID> inverted_linear_layout) {
     std::vector<NodeID> linear_layout(inverted_linear_layout.size());
@@ -121,51 +178,76 @@ double utils::calculate_per_edge_cost(graph_access &G, Functor &calculator) {
     return cost;
 }
 
+template <typename CostModel>
 double utils::calculate_partition_cost(query_graph &G) {
     auto cost = 0.0;
     auto partition_sizes = G.count_partition_sizes();
 
     for (NodeID q = 0; q < G.number_of_query_nodes(); ++q) {
         auto degrees = G.count_query_node_degrees(q);
-        for (PartitionID p = 0; p < 2; ++p) {
-            if (degrees[p] > 0) {
-                cost += degrees[p] *
-                        utils::log(static_cast<double>(partition_sizes[p]) /
-                                   (degrees[p] + 1));
-            }
-        }
+        cost += calculate_query_node_cost<CostModel>(partition_sizes, degrees);
     }
 
     assert(!std::isnan(cost));
     return cost;
 }
 
-bool utils::is_boundary_node(graph_access &G, NodeID node) {
-    PartitionID p = G.getPartitionIndex(node);
+template double utils::calculate_partition_cost<loggap_cost>(query_graph &G);
+template double utils::calculate_partition_cost<log_cost>(query_graph &G);
+template double utils::calculate_partition_cost<mla_cost>(query_graph &G);
+template double utils::calculate_partition_cost<k2tree_cost>(query_graph &G);
 
-    // a node is a boundary node if it is adjacent on a node that belongs to the
-    // other partition
-    forall_out_edges(G, edge, node) NodeID neighbor = G.getEdgeTarget(edge);
-    if (G.getPartitionIndex(neighbor) != p) {
-        return true;
+/**
+ * Calculates the partition cost of {@code G} as if its data nodes were
+ * partitioned according to {@code partition}. Does not modify {@code G}.
+ *
+ * @param G
+ * @param partition partition[data node] = partition of the data node
+ * @return
+ */
+template <typename CostModel>
+double utils::calculate_partition_cost(
+    query_graph &G, const std::vector<PartitionID> &partition) {
+    assert(partition.size() == G.number_of_data_nodes());
+
+    std::array<NodeID, 2> partition_sizes = {0, 0};
+    for (PartitionID p : partition) {
+        ++partition_sizes[p];
     }
-    endfor
 
-        return false;
+    auto cost = 0.0;
+    for (NodeID q = 0; q < G.number_of_query_nodes(); ++q) {
+        std::array<NodeID, 2> degrees = {0, 0};
+        for (NodeID v : G.get_adjacent_data_nodes(q)) {
+            ++degrees[partition[v]];
+        }
+        cost += calculate_query_node_cost<CostModel>(partition_sizes, degrees);
+    }
+
+    assert(!std::isnan(cost));
+    return cost;
 }
 
+template double utils::calculate_partition_cost<loggap_cost>(
+    query_graph &G, const std::vector<PartitionID> &partition);
+template double utils::calculate_partition_cost<log_cost>(
+    query_graph &G, const std::vector<PartitionID> &partition);
+template double utils::calculate_partition_cost<mla_cost>(
+    query_graph &G, const std::vector<PartitionID> &partition);
+template double utils::calculate_partition_cost<k2tree_cost>(
+    query_graph &G, const std::vector<PartitionID> &partition);
+
 std::vector<NodeID> utils::process_graph(
     const std::string &graph_filename, const std::string &remark,
-    initial_partitioner_interface &initial_partitioner,
-    refiner_interface &refiner, reporter &reporter,
-    bool calculate_quadtree_cost, int max_levels) {
+    const partitioner_schedule &partitioners, const refiner_schedule &refiners,
+    reporter &reporter, bool calculate_quadtree_cost, int max_levels, double time_limit, bool compress) {
     query_graph QG;
     if (graph_io::readGraphWeighted(QG.data_graph(), graph_filename) != 0) {
         std::cerr << "Graph " << graph_filename << " could not be loaded!"
                   << std::endl;
         std::exit(1);
     }
-    QG.construct_query_edges();
+    QG.construct_query_edges(compress);
 
     // report initial graph metrics
     std::vector<NodeID> identity_layout =
@@ -180,28 +262,35 @@ std::vector<NodeID> utils::process_graph(
                        -1);
     }
 
+    // the data graph is only needed again by KaHIP and for the final metrics,
+    // which materialize it from the query graph
+    QG.release_data_graph();
+
     // initiate recursive graph reordering
     auto num_recursion_levels =
-        static_cast<int>(log(QG.data_graph().number_of_nodes()));
+        static_cast<int>(log(QG.number_of_data_nodes()));
     if (max_levels > 0) {
         num_recursion_levels = std::min(num_recursion_levels, max_levels);
     }
 
-    std::vector<NodeID> inverted_layout;
-#pragma omp parallel
-    {
-#pragma omp single
-        {
-            inverted_layout =
-                find_linear_arrangement(QG, num_recursion_levels,
-                                        initial_partitioner, refiner, reporter);
-        }
-    }
+    // refinement shares the time limit (if any) across all bisections
+    time_budget budget(time_limit);
+    budget.start(QG.number_of_data_nodes(), num_recursion_levels);
+
+    // the subgraphs of all levels reuse the arrays of finished subtrees
+    subgraph_storage storage;
+
+    // the recursion itself is sequential; it must not run inside a parallel
+    // region, otherwise the parallel loops of the refiners are nested and
+    // executed by a single thread
+    std::vector<NodeID> inverted_layout =
+        find_linear_arrangement(QG, num_recursion_levels, partitioners,
+                                refiners, reporter, budget, storage);
     std::vector<NodeID> layout = invert_linear_layout(inverted_layout);
 
     // save partition
     graph_io::writePartition(
-        QG.data_graph(),
+        QG.synchronized_data_graph(),
         graph_filename + ".partition_" + std::to_string(std::time(nullptr)));
 
     // report resulting graph metrics
@@ -221,53 +310,74 @@ std::vector<NodeID> utils::process_graph(
 }
 
 std::vector<NodeID> utils::find_linear_arrangement(
-    query_graph &QG, int level, initial_partitioner_interface &partitioner,
-    refiner_interface &refiner, reporter &reporter) {
+    query_graph &QG, int level, const partitioner_schedule &partitioners,
+    const refiner_schedule &refiners, reporter &reporter, time_budget &budget,
+    subgraph_storage &storage) {
     // base case: maximum recursion depth reached or no more nodes to work with;
     // order the remaining nodes randomly
-    if (level == 0 || QG.data_graph().number_of_nodes() <= 1) {
-        std::vector<NodeID> inverted_layout(QG.data_graph().number_of_nodes());
-        forall_nodes(QG.data_graph(), v) inverted_layout[v] = v;
-        endfor
+    if (level == 0 || QG.number_of_data_nodes() <= 1) {
+        std::vector<NodeID> inverted_layout(QG.number_of_data_nodes());
+        std::iota(inverted_layout.begin(), inverted_layout.end(), 0);
 
-            std::random_device rd;
+        std::random_device rd;
         std::mt19937 g(rd());
         std::shuffle(inverted_layout.begin(), inverted_layout.end(), g);
         return inverted_layout;
     }
 
-    // perform bisection
+    // perform bisection with the components that the schedules select for this
+    // subproblem
+    initial_partitioner_interface &partitioner = partitioners.select(QG);
+    refiner_interface &refiner = refiners.select(QG);
+
     reporter.bisection_start(QG);
     partitioner.perform_partitioning(QG, level, reporter);
-    quality_metrics qm;
-    std::cout << "edge cut on level " << level << ": "
-              << qm.edge_cut(QG.data_graph())
-              << "; balance: " << qm.balance(QG.data_graph()) << std::endl;
-    refiner.perform_refinement(QG, 20, level, reporter);
-    std::cout << "after refinement: " << qm.edge_cut(QG.data_graph())
-              << "; balance: " << qm.balance(QG.data_graph()) << std::endl;
+    std::cout << "partition cost on level " << level << ": "
+              << calculate_partition_cost(QG)
+              << "; balance: " << calculate_balance(QG) << std::endl;
+    refiner.perform_refinement(QG, 20, level, reporter,
+                               budget.claim(QG.number_of_data_nodes()));
+    std::cout << "after refinement: " << calculate_partition_cost(QG)
+              << "; balance: " << calculate_balance(QG) << std::endl;
     std::array<query_graph, 2> subgraphs;
-    auto map = QG.build_partition_induced_subgraphs(subgraphs);
+    auto map = QG.build_partition_induced_subgraphs(subgraphs, storage);
     reporter.bisection_finish(QG, subgraphs[0], subgraphs[1]);
+    QG.release_data_graph();
 
     // calculate layouts recursively
     std::vector<NodeID> lower, higher;
-    lower = find_linear_arrangement(subgraphs[0], level - 1, partitioner,
-                                    refiner, reporter);
-    higher = find_linear_arrangement(subgraphs[1], level - 1, partitioner,
-                                     refiner, reporter);
+    // a subgraph gives its arrays back as soon as its subtree is finished
+    lower = find_linear_arrangement(subgraphs[0], level - 1, partitioners,
+                                    refiners, reporter, budget, storage);
+    subgraphs[0].release_storage();
+    higher = find_linear_arrangement(subgraphs[1], level - 1, partitioners,
+                                     refiners, reporter, budget, storage);
+    subgraphs[1].release_storage();
 
     // concatenate linear layouts
-    std::vector<NodeID> inverted_layout(QG.data_graph().number_of_nodes());
-    long offset = subgraphs[0].data_graph().number_of_nodes();
-    forall_nodes(QG.data_graph(),
-                 v) if (v < subgraphs[0].data_graph().number_of_nodes()) {
-        inverted_layout[v] = map[0][lower[v]];
-    }
-    else {
-        inverted_layout[v] = map[1][higher[v - offset]];
+    std::vector<NodeID> inverted_layout(QG.number_of_data_nodes());
+    NodeID offset = subgraphs[0].number_of_data_nodes();
+    for (NodeID v = 0; v < QG.number_of_data_nodes(); ++v) {
+        if (v < offset) {
+            inverted_layout[v] = map[0][lower[v]];
+        } else {
+            inverted_layout[v] = map[1][higher[v - offset]];
+        }
     }
-    endfor return inverted_layout;
+    return inverted_layout;
+}
+
+/**
+ * Calculates the size of the larger partition relative to a perfectly balanced
+ * bisection, like {@code quality_metrics::balance()} on the data graph.
+ *
+ * @param G
+ * @return
+ */
+double utils::calculate_balance(query_graph &G) {
+    auto partition_sizes = G.count_partition_sizes();
+    double optimal_size = std::ceil(G.number_of_data_nodes() / 2.0);
+    return std::max(partition_sizes[0], partition_sizes[1]) / optimal_size;
 }
 
 std::vector<PartitionID> utils::get_partition(graph_access &G) {
@@ -276,15 +386,109 @@ std::vector<PartitionID> utils::get_partition(graph_access &G) {
     endfor return partition;
 }
 
-void utils::set_partition(graph_access &G,
+std::vector<PartitionID> utils::get_partition(query_graph &G) {
+    std::vector<PartitionID> partition(G.number_of_data_nodes());
+    for (NodeID v = 0; v < G.number_of_data_nodes(); ++v) {
+        partition[v] = G.get_partition(v);
+    }
+    return partition;
+}
+
+void utils::set_partition(query_graph &G,
                           const std::vector<PartitionID> &partition) {
-    forall_nodes(G, node) G.setPartitionIndex(node, partition[node]);
-    endfor
+    assert(partition.size() == G.number_of_data_nodes());
+    for (NodeID v = 0; v < G.number_of_data_nodes(); ++v) {
+        G.set_partition(v, partition[v]);
+    }
 }
 
-void utils::reset_partition(graph_access &G) {
-    forall_nodes(G, v) G.setPartitionIndex(v, 0);
-    endfor
+void utils::reset_partition(query_graph &G) {
+    for (NodeID v = 0; v < G.number_of_data_nodes(); ++v) {
+        G.set_partition(v, 0);
+    }
+}
+
+/**
+ * Pairs the i-th best nodes of both partitions as long as the summed gain value of the pair is positive.
+ *
+ * A node can only be paired profitably if its gain value is larger than the negated maximal gain value of the other
+ * partition, which filters the nodes in a single parallel pass. The number k of pairs is then found by a binary search
+ * over the ranks: each step places the nodes of the probed rank with {@code nth_element} on the part of both lists
+ * that is not yet known to lie before or after the cut-off, hence the search takes expected linear time in the
+ * number of candidates. Only the k selected nodes of each partition are sorted.
+ *
+ * @param G
+ * @param gains gain value of every data node
+ * @return for each partition, the k nodes that are moved to the other partition in descending order of their gain
+ * values; the i-th nodes of both lists form a pair with positive summed gain value
+ */
+std::array<std::vector<NodeID>, 2> utils::select_swap_candidates(query_graph &G, const numa_vector<double> &gains) {
+    const NodeID n = G.number_of_data_nodes();
+
+    // find the maximal gain value in each partition
+    double max_gain_0 = std::numeric_limits<double>::lowest();
+    double max_gain_1 = std::numeric_limits<double>::lowest();
+#pragma omp parallel for reduction(max: max_gain_0, max_gain_1)
+    for (NodeID v = 0; v < n; ++v) {
+        if (G.get_partition(v) == 0) {
+            max_gain_0 = std::max(max_gain_0, gains[v]);
+        } else {
+            max_gain_1 = std::max(max_gain_1, gains[v]);
+        }
+    }
+    std::array<double, 2> threshold = {-max_gain_1, -max_gain_0};
+
+    // collect nodes above the threshold of their partition
+    std::array<std::vector<NodeID>, 2> S;
+#pragma omp parallel
+    {
+        std::array<std::vector<NodeID>, 2> local_S;
+
+#pragma omp for schedule(static) nowait
+        for (NodeID v = 0; v < n; ++v) {
+            PartitionID p = G.get_partition(v);
+            if (gains[v] > threshold[p]) {
+                local_S[p].push_back(v);
+            }
+        }
+
+#pragma omp critical
+        {
+            for (PartitionID p = 0; p < 2; ++p) {
+                S[p].insert(S[p].end(), local_S[p].begin(), local_S[p].end());
+            }
+        }
+    }
+
+    // break ties by node id to get the same order regardless of the number of threads
+    auto sort_by_gain = [&gains](NodeID left, NodeID right) -> bool {
+        return gains[left] > gains[right] || (gains[left] == gains[right] && left < right);
+    };
+
+    // find the number of pairs: the pair of rank i is positive iff i < k. Positions [0, lo) of both lists hold the
+    // nodes of the ranks below lo, positions [lo, end) the nodes of the ranks from lo up to the unknown cut-off
+    std::size_t lo = 0;
+    std::size_t hi = std::min(S[0].size(), S[1].size());
+    std::array<std::size_t, 2> end = {S[0].size(), S[1].size()};
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        for (PartitionID p = 0; p < 2; ++p) {
+            __gnu_parallel::nth_element(S[p].begin() + lo, S[p].begin() + mid, S[p].begin() + end[p], sort_by_gain);
+        }
+        if (gains[S[0][mid]] + gains[S[1][mid]] > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+            end = {mid, mid};
+        }
+    }
+
+    for (PartitionID p = 0; p < 2; ++p) {
+        S[p].resize(lo);
+        __gnu_parallel::sort(S[p].begin(), S[p].end(), sort_by_gain);
+    }
+
+    return S;
 }
 
 std::size_t utils::calculate_quadtree_size(graph_access &G) {
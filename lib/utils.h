@@ -3,8 +3,11 @@
 
 #include <data_structure/graph_access.h>
 #include "data-structure/query_graph.h"
+#include "refinement/cost_models.h"
 #include "refinement/refiner_interface.h"
+#include "refinement/time_budget.h"
 #include "initial-partitioner/initial_partitioner_interface.h"
+#include "schedule.h"
 
 namespace bathesis {
 
@@ -20,10 +23,14 @@ namespace bathesis {
 
         static double log(double arg);
 
+        static uint derive_seed(uint seed, std::uint64_t branch_id, uint index = 0);
+
         static std::vector<NodeID> create_identity_layout(graph_access &G);
 
         static std::vector<NodeID> create_random_layout(graph_access &G);
 
+        static std::vector<NodeID> create_bfs_layout(graph_access &G);
+
         static std::vector<NodeID> invert_linear_layout(std::vector<NodeID> inverted_linear_layout);
 
         static double calculate_loggap(graph_access &G, const std::vector<NodeID> &linear_layout);
@@ -32,24 +39,35 @@ namespace bathesis {
 
         static double calculate_mla_cost(graph_access &G, const std::vector<NodeID> &linear_layout);
 
+        template<typename CostModel = loggap_cost>
         static double calculate_partition_cost(query_graph &G);
 
-        static bool is_boundary_node(graph_access &G, NodeID node);
+        template<typename CostModel = loggap_cost>
+        static double calculate_partition_cost(query_graph &G, const std::vector<PartitionID> &partition);
+
+        static double calculate_balance(query_graph &G);
 
         static std::vector<PartitionID> get_partition(graph_access &G);
 
-        static void set_partition(graph_access &G, const std::vector<PartitionID> &partition);
+        static std::vector<PartitionID> get_partition(query_graph &G);
+
+        static void set_partition(query_graph &G, const std::vector<PartitionID> &partition);
+
+        static void reset_partition(query_graph &G);
 
-        static void reset_partition(graph_access &G);
+        static std::array<std::vector<NodeID>, 2>
+        select_swap_candidates(query_graph &G, const numa_vector<double> &gains);
 
         static std::vector<NodeID>
         process_graph(const std::string &graph_filename, const std::string &remark,
-                      initial_partitioner_interface &initial_partitioner, refiner_interface &refiner,
-                      reporter &reporter, bool calculate_quadtree_cost = false, int max_levels = 0);
+                      const partitioner_schedule &partitioners, const refiner_schedule &refiners,
+                      reporter &reporter, bool calculate_quadtree_cost = false, int max_levels = 0,
+                      double time_limit = 0.0, bool compress = false);
 
         static std::vector<NodeID>
-        find_linear_arrangement(query_graph &QG, int level, initial_partitioner_interface &partitioner,
-                                refiner_interface &refiner, reporter &reporter);
+        find_linear_arrangement(query_graph &QG, int level, const partitioner_schedule &partitioners,
+                                const refiner_schedule &refiners, reporter &reporter, time_budget &budget,
+                                subgraph_storage &storage);
 
         static std::size_t calculate_quadtree_size(graph_access &G);
 
@@ -106,12 +106,13 @@ int main(int argc, char *argv[]) {
         std::cerr << "Graph file '" << filename << "' could not be loaded" << std::endl;
         std::exit(1);
     }
-    G.construct_query_edges();
 
+    // the query graph takes over the partition of the data graph when its query edges are constructed
     if (use_partition && graph_io::readPartition(G.data_graph(), partition_filename) != 0) {
         std::cerr << "Partition file " << partition_filename << " could not be loaded" << std::endl;
         std::exit(1);
     }
+    G.construct_query_edges();
 
     std::vector<NodeID> identity = permute_randomly ? utils::create_random_layout(G.data_graph())
                                                     : utils::create_identity_layout(G.data_graph());